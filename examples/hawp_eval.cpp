@@ -11,6 +11,7 @@
 #include <waveblocks/utilities/timer.hpp>
 
 #include <waveblocks/wavepackets/hawp_commons.hpp>
+#include <waveblocks/wavepackets/hawp_batch_evaluator.hpp>
 #include <waveblocks/wavepackets/hawp_gradient_operator.hpp>
 #include <waveblocks/wavepackets/shapes/tiny_multi_index.hpp>
 #include <waveblocks/wavepackets/shapes/shape_commons.hpp>
@@ -211,4 +212,41 @@ int main(int argc, char* argv[])
         std::cout << "   time (evaluate):  " << time_evaluate  << " [ms] " << std::endl;
     }
     std::cout << std::endl;
+
+
+    const int n_packets = 16;
+    std::cout << boost::format("Evaluate ensemble of %i wavepackets on %i quadrature points") % n_packets % grid.cols() << std::endl;
+    {
+        // half of the ensemble shares the parameter set, the other half is shifted in position space
+        std::vector< wavepackets::ScalarHaWp<D,MultiIndex> > ensemble(n_packets, wp);
+        std::vector< wavepackets::AbstractScalarHaWp<D,MultiIndex> const* > packets(n_packets);
+        for (int i = 0; i < n_packets; i++) {
+            ensemble[i].coefficients() *= std::exp(complex_t(0,0.1*i));
+            if (i % 2) {
+                RMatrix<D,1> q = wp.parameters().q() + RMatrix<D,1>::Constant(0.01*i);
+                ensemble[i].parameters() = wavepackets::HaWpParamSet<D>(q, wp.parameters().p(), wp.parameters().Q(), wp.parameters().P(), 0);
+            }
+            packets[i] = &ensemble[i];
+        }
+
+        CMatrix<Eigen::Dynamic,numQ> result(n_packets,numQ);
+
+        timer.start();
+        for (int i = 0; i < n_packets; i++)
+            result.row(i) = ensemble[i].evaluate(grid);
+        timer.stop();
+        double time_single = timer.millis();
+
+        wavepackets::HaWpBatchEvaluator<D,MultiIndex,numQ> batch(grid);
+
+        timer.start();
+        CMatrix<Eigen::Dynamic,numQ> batch_result = batch.reduce(packets).matrix();
+        timer.stop();
+        double time_batch = timer.millis();
+
+        std::cout << "   max deviation: " << (batch_result - result).cwiseAbs().maxCoeff() << std::endl;
+        std::cout << "   time (one by one): " << time_single << " [ms] " << std::endl;
+        std::cout << "   time (batch):      " << time_batch  << " [ms] " << std::endl;
+    }
+    std::cout << std::endl;
 }
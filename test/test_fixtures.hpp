@@ -0,0 +1,98 @@
+#pragma once
+
+#include <iostream>
+#include <cmath>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/shapes/shape_base.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+
+
+namespace waveblocks {
+    namespace test {
+        /**
+         * Scalar wavepacket with non-diagonal parameters and oscillating coefficients
+         * \f$ c_i = e^{(g + 0.7i) i} / \sqrt{|\mathfrak{K}|} \f$.
+         *
+         * \param shape The basis shape.
+         * \param diagonal Keep \f$ Q \f$ and \f$ P \f$ diagonal.
+         * \param growth Exponential growth rate \f$ g \f$ of the coefficients.
+         */
+        template<dim_t D, class MultiIndex>
+        wavepackets::ScalarHaWp<D,MultiIndex> create_wavepacket(wavepackets::shapes::AbstractShape<D> const& shape,
+                                                                bool diagonal = false,
+                                                                real_t growth = 0.1)
+        {
+            wavepackets::ScalarHaWp<D,MultiIndex> wp;
+            wp.eps() = 0.7;
+
+            // Q = c*A, P = i/conj(c)*A^{-T} + c*S*A with symmetric S satisfies the symplectic conditions
+            RMatrix<D,D> A = RMatrix<D,D>::Identity();
+            RMatrix<D,D> S = RMatrix<D,D>::Zero();
+            RMatrix<D,1> q, p;
+            for (int i = 0; i < D; i++) {
+                q(i,0) = 0.1*std::cos(0.8*i);
+                p(i,0) = 0.2*std::sin(0.9*i + 0.3);
+                for (int j = 0; j < D; j++) {
+                    if (i != j && !diagonal) A(i,j) = 0.2*std::sin(1.0 + i + 2.0*j);
+                    if (i == j || !diagonal) S(i,j) = 0.1*std::cos(0.5*(i + j));
+                }
+            }
+            complex_t c = std::exp(complex_t(0.1, 0.3));
+
+            CMatrix<D,D> Q = c*A.template cast<complex_t>();
+            CMatrix<D,D> P = complex_t(0,1)/std::conj(c)*A.inverse().transpose().template cast<complex_t>()
+                           + c*(S*A).template cast<complex_t>();
+            wp.parameters() = wavepackets::HaWpParamSet<D>(q,p,Q,P,0);
+
+            wavepackets::shapes::ShapeEnumerator<D,MultiIndex> enumerator;
+            wp.shape() = enumerator.enumerate(shape);
+
+            std::size_t bsize = wp.shape()->n_entries();
+            wp.coefficients() = Coefficients(bsize);
+            for (std::size_t i = 0; i < bsize; i++) {
+                wp.coefficients()[i] = std::exp(complex_t(growth*i, 0.7*i))/std::sqrt(bsize);
+            }
+
+            return wp;
+        }
+
+        /**
+         * Simplex \f$ \sum_d k_d < S \f$.
+         */
+        template<dim_t D>
+        class SimplexShape : public wavepackets::shapes::AbstractShape<D>
+        {
+        public:
+            SimplexShape(int S) : S_(S) {}
+
+            virtual int limit(int const* base_node, dim_t axis) const override
+            {
+                int sum = 0;
+                for (dim_t d = 0; d < D; d++) {
+                    if (d != axis)
+                        sum += base_node[d];
+                }
+                return S_ - 1 - sum;
+            }
+
+            virtual int bbox(dim_t) const override
+            {
+                return S_ - 1;
+            }
+
+            virtual void print(std::ostream & out) const override
+            {
+                out << "SimplexShape{" << S_ << "}";
+            }
+
+        private:
+            int S_;
+        };
+    }
+}
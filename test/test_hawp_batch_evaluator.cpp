@@ -0,0 +1,113 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_batch_evaluator.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Evaluates an interleaved ensemble with HaWpBatchEvaluator and compares each row
+ * against the packet's own evaluate(). Three packets share all parameters and the shape,
+ * the others differ in the parameter set, in eps or in the shape, thus they form groups of their own.
+ */
+template<dim_t D, int N, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp,
+             wavepackets::shapes::AbstractShape<D> const& other_shape,
+             int npts)
+{
+    typedef wavepackets::ScalarHaWp<D,MultiIndex> Packet;
+
+    RMatrix<D,N> rgrid(D, npts);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < npts; j++) {
+            rgrid(i,j) = -1.0 + 2.0*j/(npts-1) + 0.1*i;
+        }
+    }
+    CMatrix<D,N> cgrid = rgrid.template cast<complex_t>();
+    cgrid.row(0).array() += complex_t(0, 0.05);
+
+    std::vector<Packet> ensemble(6, wp);
+
+    // same parameters and shape, different coefficients
+    for (int i : {2, 4}) {
+        for (long k = 0; k < ensemble[i].coefficients().size(); k++)
+            ensemble[i].coefficients()[k] *= std::exp(complex_t(0, 0.4*i*k));
+    }
+
+    // different position
+    RMatrix<D,1> shift = RMatrix<D,1>::Zero();
+    shift(0,0) = 0.2;
+    ensemble[1].parameters().updateq(shift);
+
+    // different shape
+    ensemble[3].shape() = wavepackets::shapes::ShapeEnumerator<D,MultiIndex>().enumerate(other_shape);
+    ensemble[3].coefficients() = Coefficients::Ones(ensemble[3].shape()->n_entries()) / std::sqrt(ensemble[3].shape()->n_entries());
+
+    // different eps
+    ensemble[5].eps() = 0.6;
+
+    std::vector<wavepackets::AbstractScalarHaWp<D,MultiIndex> const*> packets;
+    for (auto const& packet : ensemble)
+        packets.push_back(&packet);
+
+    CArray<Eigen::Dynamic,N> expected_c(packets.size(), npts);
+    CArray<Eigen::Dynamic,N> expected_r(packets.size(), npts);
+    for (std::size_t i = 0; i < packets.size(); i++) {
+        expected_c.row(i) = ensemble[i].evaluate(cgrid);
+        expected_r.row(i) = ensemble[i].evaluate(rgrid);
+    }
+
+    CArray<Eigen::Dynamic,N> actual_c = wavepackets::HaWpBatchEvaluator<D,MultiIndex,N>(cgrid).reduce(packets);
+    CArray<Eigen::Dynamic,N> actual_r = wavepackets::HaWpBatchEvaluator<D,MultiIndex,N>(rgrid).reduce(packets);
+
+    real_t dev_c = (actual_c - expected_c).abs().maxCoeff() / expected_c.abs().maxCoeff();
+    real_t dev_r = (actual_r - expected_r).abs().maxCoeff() / expected_r.abs().maxCoeff();
+
+    std::cout << "D = " << D << ", packets = " << packets.size() << ", N = " << npts
+              << (N == Eigen::Dynamic ? " (dynamic)" : "") << std::endl;
+    std::cout << "   max rel. deviation complex grid: " << dev_c << std::endl;
+    std::cout << "   max rel. deviation real grid:    " << dev_r << std::endl;
+
+    return actual_c.rows() == (long)packets.size() && dev_c < 1e-12 && dev_r < 1e-12;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef wavepackets::shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(20));
+        ok &= compare<D,9,MultiIndex>(wp, wavepackets::shapes::HyperCubicShape<D>(12), 9);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(10));
+        ok &= compare<D,16,MultiIndex>(wp, wavepackets::shapes::HyperCubicShape<D>(4), 16);
+        ok &= compare<D,Eigen::Dynamic,MultiIndex>(wp, wavepackets::shapes::HyperCubicShape<D>(4), 45);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= compare<D,7,MultiIndex>(wp, wavepackets::shapes::HyperbolicCutShape<D>(6), 7);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
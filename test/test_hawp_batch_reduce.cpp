@@ -0,0 +1,99 @@
+#include <iostream>
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_evaluator.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Contracts C coefficient rows at once with batch_reduce() (with and without Kahan summation)
+ * and compares each row against a separate reduce() call.
+ */
+template<dim_t D, int N, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp, int npts, int C)
+{
+    CMatrix<D,N> grid(D, npts);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < npts; j++) {
+            grid(i,j) = complex_t(-1.0 + 2.0*j/(npts-1) + 0.1*i, 0.05*std::sin(j + i));
+        }
+    }
+
+    const long size = wp.shape()->n_entries();
+
+    CMatrix<Eigen::Dynamic,Eigen::Dynamic> coefficients(C, size);
+    for (int c = 0; c < C; c++) {
+        for (long k = 0; k < size; k++)
+            coefficients(c,k) = wp.coefficients()[k] * std::exp(complex_t(0, 0.3*c*k));
+    }
+
+    auto evaluator = wp.template create_evaluator<N>(grid);
+
+    CArray<Eigen::Dynamic,N> expected(C, npts);
+    for (int c = 0; c < C; c++) {
+        Coefficients row = coefficients.row(c).transpose();
+        expected.row(c) = evaluator.reduce(row);
+    }
+
+    wavepackets::HaWpEvaluatorWorkspace<N> workspace;
+
+    CArray<Eigen::Dynamic,N> compensated = evaluator.batch_reduce(coefficients);
+    CArray<Eigen::Dynamic,N> plain = evaluator.batch_reduce(coefficients, false);
+    CArray<Eigen::Dynamic,N> reused = evaluator.batch_reduce(coefficients, true, workspace);
+    reused = evaluator.batch_reduce(coefficients, true, workspace);
+
+    real_t scale = expected.abs().maxCoeff();
+    real_t dev_compensated = (compensated - expected).abs().maxCoeff() / scale;
+    real_t dev_plain = (plain - expected).abs().maxCoeff() / scale;
+    real_t dev_reused = (reused - compensated).abs().maxCoeff();
+
+    std::cout << "D = " << D << ", |K| = " << size << ", C = " << C << ", N = " << npts
+              << (N == Eigen::Dynamic ? " (dynamic)" : "") << std::endl;
+    std::cout << "   max rel. deviation compensated: " << dev_compensated << std::endl;
+    std::cout << "   max rel. deviation plain:       " << dev_plain << std::endl;
+    std::cout << "   max deviation with workspace:   " << dev_reused << std::endl;
+
+    return compensated.rows() == C && dev_compensated < 1e-12 && dev_plain < 1e-12 && dev_reused == 0;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef wavepackets::shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(20));
+        ok &= compare<D,9,MultiIndex>(wp, 9, 4);
+        ok &= compare<D,Eigen::Dynamic,MultiIndex>(wp, 9, 4);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(10));
+        ok &= compare<D,16,MultiIndex>(wp, 16, 3);
+        ok &= compare<D,Eigen::Dynamic,MultiIndex>(wp, 101, 3);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= compare<D,7,MultiIndex>(wp, 7, 5);
+        ok &= compare<D,Eigen::Dynamic,MultiIndex>(wp, 77, 5);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
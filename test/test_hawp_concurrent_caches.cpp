@@ -0,0 +1,105 @@
+#include <iostream>
+#include <vector>
+
+#include <Eigen/StdVector>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets;
+using namespace waveblocks::wavepackets::shapes;
+
+const dim_t D = 2;
+typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+
+/**
+ * Calls the caching const member functions of shared packets from many threads at once
+ * and compares the results with sequential calls.
+ */
+int main()
+{
+    bool ok = true;
+
+    ShapeEnumerator<D,MultiIndex> enumerator;
+
+    std::vector< ScalarHaWp<D,MultiIndex>, Eigen::aligned_allocator< ScalarHaWp<D,MultiIndex> > > scalar(8);
+    for (std::size_t i = 0; i < scalar.size(); i++)
+        scalar[i].shape() = enumerator.enumerate(LimitedHyperbolicCutShape<D>(10 + i%3, {8,8}));
+
+    HomogeneousHaWp<D,MultiIndex> packet(3);
+    packet.eps() = 0.5;
+    for (std::size_t c = 0; c < packet.n_components(); c++) {
+        packet.component(c).shape() = enumerator.enumerate(HyperCubicShape<D>({int(4+c), int(6-c)}));
+        packet.component(c).coefficients() = CMatrix<Eigen::Dynamic,1>::Random(packet.component(c).shape()->n_entries());
+    }
+
+    RMatrix<D,Eigen::Dynamic> grid = RMatrix<D,Eigen::Dynamic>::Random(D, 40);
+
+    // reference results, computed by a copy of the packet
+    std::vector< ShapeEnum<D,MultiIndex> > extensions;
+    for (auto const& wp : scalar)
+        extensions.push_back(shape_enum::extend(wp.shape().get()));
+
+    auto union_of = [](HomogeneousHaWp<D,MultiIndex> const& packet) {
+        std::vector< ShapeEnum<D,MultiIndex> const* > list;
+        for (std::size_t c = 0; c < packet.n_components(); c++)
+            list.push_back(packet.component(c).shape().get());
+        return shape_enum::strict_union<D,MultiIndex>(list);
+    };
+    ShapeEnum<D,MultiIndex> expected_union = union_of(packet);
+
+    CArray<Eigen::Dynamic,Eigen::Dynamic> expected(packet.n_components(), grid.cols());
+    for (std::size_t c = 0; c < packet.n_components(); c++)
+        expected.row(c) = packet.component(c).evaluate(grid);
+
+    const int ntasks = 400;
+    std::vector<int> failures(ntasks, 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int task = 0; task < ntasks; task++) {
+        auto const& wp = scalar[task % scalar.size()];
+        if (!(*wp.extended_shape() == extensions[task % scalar.size()]))
+            failures[task]++;
+
+        HomogeneousHaWp<D,MultiIndex> const& shared = packet;
+        CArray<Eigen::Dynamic,Eigen::Dynamic> values = shared.template evaluate<Eigen::Dynamic>(grid);
+        if ((values - expected).abs().maxCoeff() > 1e-12)
+            failures[task]++;
+
+        if (!(*shared.union_shape() == expected_union))
+            failures[task]++;
+    }
+
+    int nfailures = 0;
+    for (int f : failures)
+        nfailures += f;
+
+    std::cout << "concurrent extended_shape(), evaluate(), union_shape(): " << nfailures << " failures" << std::endl;
+    ok &= nfailures == 0;
+
+    // replacing a shape invalidates the caches
+    {
+        auto old_extension = scalar[0].extended_shape();
+        scalar[0].shape() = enumerator.enumerate(HyperCubicShape<D>({3,3}));
+        ok &= scalar[0].extended_shape() != old_extension && *scalar[0].extended_shape() == shape_enum::extend(scalar[0].shape().get());
+
+        packet.component(2).shape() = enumerator.enumerate(HyperCubicShape<D>({7,1}));
+        packet.component(2).coefficients() = CMatrix<Eigen::Dynamic,1>::Random(7);
+        ok &= *packet.union_shape() == union_of(packet) && !(*packet.union_shape() == expected_union);
+
+        // a copy takes the cache along
+        ScalarHaWp<D,MultiIndex> copy = scalar[0];
+        ok &= copy.extended_shape() == scalar[0].extended_shape();
+
+        std::cout << "invalidation: " << (ok ? "ok" : "FAILED") << std::endl;
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <cmath>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/hawp_gradient_operator.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+template<dim_t D, int N, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp)
+{
+    RMatrix<D,N> grid;
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < N; j++) {
+            grid(i,j) = -1.0 + 2.0*j/(N-1) + 0.1*i;
+        }
+    }
+
+    wavepackets::HaWpGradientOperator<D,MultiIndex> nabla;
+    wavepackets::HaWpGradient<D,MultiIndex> gradwp = nabla(wp);
+
+    CArray<Eigen::Dynamic,N> expected = gradwp.template evaluate<N>(grid);
+    CArray<Eigen::Dynamic,N> actual = wp.template evaluate_gradient<N>(grid);
+
+    real_t dev_value = (actual.row(0) - wp.template evaluate<N>(grid)).abs().maxCoeff();
+    real_t dev_grad = (actual.bottomRows(D) - expected).abs().maxCoeff() / expected.abs().maxCoeff();
+
+    std::cout << "D = " << D << ", |K| = " << wp.shape()->n_entries() << ", N = " << N << std::endl;
+    std::cout << "   max deviation value:             " << dev_value << std::endl;
+    std::cout << "   max rel. deviation gradient:     " << dev_grad << std::endl;
+
+    return dev_value < 1e-12 && dev_grad < 1e-10;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef wavepackets::shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(20));
+        ok &= compare<D,9>(wp);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(8));
+        ok &= compare<D,16>(wp);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= compare<D,7>(wp);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <cmath>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+#include "waveblocks/innerproducts/genz_keister_qr.hpp"
+#include "waveblocks/innerproducts/homogeneous_inner_product.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Compares single and mixed precision evaluation against double precision.
+ */
+template<dim_t D, int N, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp)
+{
+    RMatrix<D,Eigen::Dynamic> grid(D, N);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < N; j++) {
+            grid(i,j) = -1.0 + 2.0*j/(N-1) + 0.1*i;
+        }
+    }
+
+    HaWpBasisVector<Eigen::Dynamic> basis = wp.evaluate_basis(grid);
+    HaWpBasisVector<Eigen::Dynamic,float> fbasis = wp.template evaluate_basis_as<float>(grid);
+
+    CArray<1,Eigen::Dynamic> psi = wp.evaluate(grid);
+    Eigen::Array<std::complex<float>,1,Eigen::Dynamic> fpsi = wp.template evaluate_as<float>(grid);
+    CArray<1,Eigen::Dynamic> mpsi = wp.template evaluate_as<float,double>(grid);
+
+    real_t dev_basis = (fbasis.template cast<complex_t>() - basis).abs().maxCoeff() / basis.abs().maxCoeff();
+    real_t dev_float = (fpsi.template cast<complex_t>() - psi).abs().maxCoeff() / psi.abs().maxCoeff();
+    real_t dev_mixed = (mpsi - psi).abs().maxCoeff() / psi.abs().maxCoeff();
+
+    std::cout << "D = " << D << ", |K| = " << wp.shape()->n_entries() << ", N = " << N
+              << ", separable = " << wp.create_evaluator(grid).separable() << std::endl;
+    std::cout << "   max rel. deviation basis (float):    " << dev_basis << std::endl;
+    std::cout << "   max rel. deviation reduce (float):   " << dev_float << std::endl;
+    std::cout << "   max rel. deviation reduce (mixed):   " << dev_mixed << std::endl;
+
+    return dev_basis < 1e-4 && dev_float < 1e-4 && dev_mixed < 1e-4;
+}
+
+/**
+ * Compares the homogeneous inner product with float basis values against double precision.
+ */
+template<dim_t D, class MultiIndex>
+bool compare_inner_product(wavepackets::ScalarHaWp<D,MultiIndex> const& wp)
+{
+    using QR = innerproducts::GenzKeisterQR<D, 8>;
+
+    CMatrix<Eigen::Dynamic,Eigen::Dynamic> M = innerproducts::HomogeneousInnerProduct<D,MultiIndex,QR>::build_matrix(wp);
+    CMatrix<Eigen::Dynamic,Eigen::Dynamic> Mf = innerproducts::HomogeneousInnerProduct<D,MultiIndex,QR,float>::build_matrix(wp);
+    CMatrix<Eigen::Dynamic,Eigen::Dynamic> Mm = innerproducts::HomogeneousInnerProduct<D,MultiIndex,QR,float,double>::build_matrix(wp);
+
+    real_t dev_float = (Mf - M).cwiseAbs().maxCoeff() / M.cwiseAbs().maxCoeff();
+    real_t dev_mixed = (Mm - M).cwiseAbs().maxCoeff() / M.cwiseAbs().maxCoeff();
+
+    std::cout << "   max rel. deviation inner product (float): " << dev_float << std::endl;
+    std::cout << "   max rel. deviation inner product (mixed): " << dev_mixed << std::endl;
+
+    return dev_float < 1e-4 && dev_mixed < 1e-4;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef wavepackets::shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(12), false, -0.05);
+        ok &= compare<D,9>(wp);
+        ok &= compare_inner_product<D,MultiIndex>(wp);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(6), true, -0.05);
+        ok &= compare<D,16>(wp);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5), false, -0.05);
+        ok &= compare<D,21>(wp);
+        ok &= compare_inner_product<D,MultiIndex>(wp);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Evaluates the wavepacket with 1, 2, 3 and 4 threads and compares the results bitwise.
+ * Checks reduce() and reduce_tiled(), both with a workspace that is reused across the calls.
+ */
+template<dim_t D, int N, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp, int npts)
+{
+    CMatrix<D,N> grid(D, npts);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < npts; j++) {
+            grid(i,j) = complex_t(-1.0 + 2.0*j/(npts-1) + 0.1*i, 0.05*std::sin(j + i));
+        }
+    }
+
+    auto evaluator = wp.template create_evaluator<N>(grid);
+
+    // contract the complete basis as reference
+    CArray<1,N> expected = (wp.coefficients().transpose() * evaluator.all().matrix()).array();
+
+    wavepackets::HaWpEvaluatorWorkspace<N> workspace;
+
+    CArray<1,N> reference, reference_tiled;
+    bool bitwise = true;
+
+    for (int nthreads = 1; nthreads <= 4; nthreads++) {
+#ifdef _OPENMP
+        omp_set_num_threads(nthreads);
+#endif
+        CArray<1,N> psi = evaluator.reduce(wp.coefficients(), workspace);
+        CArray<1,N> psi_tiled = evaluator.reduce_tiled(wp.coefficients(), workspace, 64);
+
+        if (nthreads == 1) {
+            reference = psi;
+            reference_tiled = psi_tiled;
+        }
+        else {
+            bitwise &= (psi == reference).all() && (psi_tiled == reference_tiled).all();
+        }
+    }
+
+    real_t dev = (reference - expected).abs().maxCoeff() / expected.abs().maxCoeff();
+    real_t dev_tiled = (reference_tiled - expected).abs().maxCoeff() / expected.abs().maxCoeff();
+
+    std::cout << "D = " << D << ", |K| = " << wp.shape()->n_entries() << ", N = " << npts
+              << (N == Eigen::Dynamic ? " (dynamic)" : "") << std::endl;
+    std::cout << "   bitwise identical for 1..4 threads:   " << (bitwise ? "yes" : "no") << std::endl;
+    std::cout << "   max rel. deviation from all():        " << dev << std::endl;
+    std::cout << "   max rel. deviation of reduce_tiled():  " << dev_tiled << std::endl;
+
+    return bitwise && dev < 1e-12 && dev_tiled < 1e-12;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(10));
+        ok &= compare<D,Eigen::Dynamic,MultiIndex>(wp, 1000);
+        ok &= compare<D,600,MultiIndex>(wp, 600);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= compare<D,Eigen::Dynamic,MultiIndex>(wp, 777);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+
+using namespace waveblocks;
+
+template<dim_t D, class MultiIndex>
+wavepackets::ScalarHaWp<D,MultiIndex> create_wavepacket(wavepackets::shapes::AbstractShape<D> const& shape)
+{
+    wavepackets::ScalarHaWp<D,MultiIndex> wp;
+    wp.eps() = 0.9;
+
+    // diagonal Q and P
+    RMatrix<D,1> q = RMatrix<D,1>::Zero();
+    RMatrix<D,1> p = RMatrix<D,1>::Zero();
+    CMatrix<D,D> Q = CMatrix<D,D>::Zero();
+    CMatrix<D,D> P = CMatrix<D,D>::Zero();
+    for (int i = 0; i < D; i++) {
+        p(i,0) = 0.1*std::sin(0.9*i);
+        q(i,0) = 0.1*std::cos(0.8*i);
+        Q(i,i) = std::exp(complex_t(0.1*i, 0.3*i));
+        P(i,i) = complex_t(0,1)/Q(i,i) + 0.2*std::exp(complex_t(0,0.7*i))*Q(i,i); // Q^T P - P^T Q = 0
+    }
+    wp.parameters() = wavepackets::HaWpParamSet<D>(q,p,Q,P,0);
+
+    wavepackets::shapes::ShapeEnumerator<D,MultiIndex> enumerator;
+    wp.shape() = enumerator.enumerate(shape);
+
+    std::size_t bsize = wp.shape()->n_entries();
+    wp.coefficients() = Coefficients(bsize);
+    for (std::size_t i = 0; i < bsize; i++) {
+        wp.coefficients()[i] = std::exp(complex_t(0,i))/std::sqrt(bsize);
+    }
+
+    return wp;
+}
+
+template<dim_t D, int N, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp, bool expect_separable)
+{
+    const int npts = (N == Eigen::Dynamic) ? 16 : N;
+
+    CMatrix<D,N> grid(D,npts);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < npts; j++) {
+            grid(i,j) = complex_t(-1.0 + 2.0*j/std::max(npts-1,1) + 0.1*i, 0.05*j);
+        }
+    }
+
+    auto evaluator = wp.template create_evaluator<N>(grid);
+
+    const auto separable = wavepackets::HaWpEvaluationMode::Separable;
+
+    // the default evaluation always runs the full recursion, the fast path is opt-in
+    wavepackets::HaWpEvaluatorWorkspace<N> workspace;
+
+    auto basis = evaluator.all();
+    auto psi = evaluator.reduce(wp.coefficients());
+
+    real_t dev_basis = (basis - evaluator.all(separable)).abs().maxCoeff();
+    real_t dev_reduce = (psi - evaluator.reduce(wp.coefficients(), separable)).abs().maxCoeff();
+    real_t dev_workspace = (psi - evaluator.reduce(wp.coefficients(), workspace, separable)).abs().maxCoeff();
+
+    // without fast path, the default evaluation matches the tiled recursion
+    real_t dev_tiled = (psi - evaluator.reduce_tiled(wp.coefficients())).abs().maxCoeff();
+
+    std::cout << "D = " << D << ", |K| = " << wp.shape()->n_entries() << ", N = " << npts
+              << ", separable = " << evaluator.separable() << std::endl;
+    std::cout << "   max deviation all() with fast path:    " << dev_basis << std::endl;
+    std::cout << "   max deviation reduce() with fast path: " << std::max(dev_reduce, dev_workspace) << std::endl;
+    std::cout << "   max deviation reduce_tiled():          " << dev_tiled << std::endl;
+
+    bool passed = evaluator.separable() == expect_separable && dev_basis < 1e-12 && dev_reduce < 1e-12
+               && dev_workspace < 1e-12 && dev_tiled < 1e-12;
+
+    // non-separable bases fall back to the recursion
+    if (!expect_separable)
+        passed &= dev_basis == 0 && dev_reduce == 0 && dev_workspace == 0;
+
+    return passed;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef wavepackets::shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+        auto wp = create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(30));
+        ok &= compare<D,9>(wp, true);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(10));
+        ok &= compare<D,16>(wp, true);
+        ok &= compare<D,Eigen::Dynamic>(wp, true);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(6));
+        ok &= compare<D,1>(wp, true);
+        ok &= compare<D,7>(wp, true);
+
+        auto cut = create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 6));
+        ok &= compare<D,7>(cut, false);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
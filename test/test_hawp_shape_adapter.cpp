@@ -0,0 +1,312 @@
+#include <iostream>
+#include <cmath>
+#include <string>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/potentials/potentials.hpp"
+#include "waveblocks/potentials/bases.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_shape_adapter.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_hypercubic.hpp"
+#include "waveblocks/innerproducts/gauss_hermite_qr.hpp"
+#include "waveblocks/propagators/HagedornPropagator.hpp"
+#include "waveblocks/propagators/MG4Propagator.hpp"
+#include "waveblocks/propagators/McL42Propagator.hpp"
+#include "waveblocks/propagators/Pre764Propagator.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets;
+
+/**
+ * Checks that every backward neighbour of every node is part of the shape.
+ */
+template<dim_t D, class MultiIndex>
+bool closed(shapes::ShapeEnum<D,MultiIndex> const& shape)
+{
+    bool ok = true;
+    for (int islice = 0; islice < shape.n_slices(); islice++) {
+        for (auto const& index : shape.slice(islice)) {
+            for (dim_t d = 0; d < D; d++) {
+                if (index[d] == 0)
+                    continue;
+                MultiIndex prev = index;
+                prev[d] -= 1;
+                std::size_t ordinal;
+                ok &= shape.slice(islice-1).try_find(prev, ordinal);
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * Coefficient of a node or zero, if the node is not part of the shape.
+ */
+template<dim_t D, class MultiIndex>
+complex_t coefficient(ScalarHaWp<D,MultiIndex> const& packet, MultiIndex const& index)
+{
+    int islice = 0;
+    for (dim_t d = 0; d < D; d++)
+        islice += index[d];
+
+    auto const& slice = packet.shape()->slice(islice);
+    std::size_t ordinal;
+    if (!slice.try_find(index, ordinal))
+        return 0;
+    return packet.coefficients()[slice.offset() + ordinal];
+}
+
+bool test_prune_and_grow()
+{
+    const dim_t D = 2;
+    typedef shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+
+    bool ok = true;
+
+    ScalarHaWp<D,MultiIndex> packet;
+    packet.eps() = 0.1;
+    packet.shape() = shapes::ShapeEnumerator<D,MultiIndex>().enumerate(shapes::HyperCubicShape<D>(8));
+    packet.coefficients() = 1e-14 * Coefficients::Ones(packet.shape()->n_entries());
+
+    RMatrix<D,Eigen::Dynamic> grid = RMatrix<D,Eigen::Dynamic>::Random(D,50);
+
+    // prune: only (0,0), (1,0) and (0,2) are significant, (0,1) must be kept for (0,2)
+    {
+        ScalarHaWp<D,MultiIndex> adapted = packet;
+        adapted.coefficients() = packet.coefficients();
+        auto set = [&](MultiIndex index, complex_t value) {
+            int islice = index[0] + index[1];
+            std::size_t ordinal = adapted.shape()->slice(islice).find(index);
+            adapted.coefficients()[adapted.shape()->slice(islice).offset() + ordinal] = value;
+        };
+        set(MultiIndex{0,0}, 1.0);
+        set(MultiIndex{1,0}, 0.5);
+        set(MultiIndex{0,2}, complex_t(0.,0.2));
+
+        ScalarHaWp<D,MultiIndex> reference = adapted;
+        reference.coefficients() = adapted.coefficients();
+
+        HaWpShapeAdapter<D,MultiIndex> adapter(1e-8, 1.0);
+        bool changed = adapter.adapt(adapted);
+
+        ok &= changed && adapted.shape()->n_entries() == 4 && closed(*adapted.shape());
+        ok &= coefficient(adapted, MultiIndex{1,0}) == complex_t(0.5) && coefficient(adapted, MultiIndex{0,2}) == complex_t(0.,0.2);
+
+        real_t dev = (adapted.evaluate(grid) - reference.evaluate(grid)).abs().maxCoeff();
+        ok &= dev < 1e-10;
+
+        std::cout << "prune: |K| = " << packet.shape()->n_entries() << " -> " << adapted.shape()->n_entries()
+                  << ", max deviation " << dev << std::endl;
+
+        // nothing left to do
+        auto shape = adapted.shape();
+        ok &= !adapter.adapt(adapted) && adapted.shape() == shape;
+    }
+
+    // grow: mass on the boundary of a 2x2 square
+    {
+        ScalarHaWp<D,MultiIndex> adapted = packet;
+        adapted.shape() = shapes::ShapeEnumerator<D,MultiIndex>().enumerate(shapes::HyperCubicShape<D>(2));
+        adapted.coefficients() = Coefficients(4);
+        adapted.coefficients() << 1.0, 1e-12, 0.3, 0.4; // (0,0), (0,1), (1,0), (1,1)
+
+        ScalarHaWp<D,MultiIndex> reference = adapted;
+        reference.coefficients() = adapted.coefficients();
+
+        HaWpShapeAdapter<D,MultiIndex> adapter(1e-8, 1e-3);
+        bool changed = adapter.adapt(adapted);
+
+        // (0,1) is negligible, but needed by (1,1); (0,2) is not needed by any significant node
+        ok &= changed && closed(*adapted.shape());
+        ok &= coefficient(adapted, MultiIndex{0,1}) == complex_t(1e-12);
+        ok &= adapted.shape()->slice(3).size() == 2; // (2,1), (1,2)
+        ok &= coefficient(adapted, MultiIndex{2,1}) == complex_t(0);
+        ok &= adapted.shape()->n_entries() == 8; // (0,0) (0,1) (1,0) (1,1) (1,2) (2,0) (2,1) (0,2)
+
+        real_t dev = (adapted.evaluate(grid) - reference.evaluate(grid)).abs().maxCoeff();
+        ok &= dev < 1e-10;
+
+        std::cout << "grow: |K| = 4 -> " << adapted.shape()->n_entries() << ", max deviation " << dev << std::endl;
+
+        // limited growth
+        ScalarHaWp<D,MultiIndex> limited = reference;
+        limited.coefficients() = reference.coefficients();
+        ok &= !HaWpShapeAdapter<D,MultiIndex>(1e-14, 1e-3, 6).adapt(limited) && limited.shape()->n_entries() == 4;
+    }
+
+    // homogeneous packet: components are adapted independently, identical results share the shape
+    {
+        HomogeneousHaWp<D,MultiIndex> homogeneous(2);
+        homogeneous.eps() = 0.1;
+        for (auto& component : homogeneous.components()) {
+            component.shape() = packet.shape();
+            component.coefficients() = Coefficients::Zero(packet.shape()->n_entries());
+            component.coefficients()[0] = 1.0;
+        }
+
+        ok &= HaWpShapeAdapter<D,MultiIndex>(1e-8, 1.0).adapt(homogeneous);
+        ok &= homogeneous.component(0).shape()->n_entries() == 1;
+        ok &= homogeneous.component(0).shape() == homogeneous.component(1).shape();
+    }
+
+    return ok;
+}
+
+const int N = 1;
+const int D = 1;
+
+/**
+ * Morse potential (same as examples/morse_1D.cpp).
+ */
+class Potential : public potentials::modules::evaluation::Abstract<Potential,CanonicalBasis<N,D>>,
+                  public potentials::modules::taylor::Abstract<Potential,CanonicalBasis<N,D>>,
+                  public potentials::modules::localRemainder::Abstract<Potential,N,D>,
+                  public LeadingLevelOwner<potentials::modules::taylor::Abstract<Potential,CanonicalBasis<N,D>>>
+{
+public:
+    using Taylor = potentials::modules::taylor::Abstract<Potential,CanonicalBasis<N,D>>;
+
+    Taylor::potential_evaluation_type evalV(const Taylor::argument_type& x) const {
+        return 0.004164 * (std::exp(-2.*0.896696*(x-5.542567)) - 2.*std::exp(-0.896696*(x-5.542567)));
+    }
+
+    Taylor::jacobian_evaluation_type evalJ(const Taylor::argument_type& x) const {
+        return 0.004164 * (-2.*0.896696*std::exp(-2.*0.896696*(x-5.542567)) + 2.*0.896696*std::exp(-0.896696*(x-5.542567)));
+    }
+
+    Taylor::hessian_evaluation_type evalH(const Taylor::argument_type& x) const {
+        return 0.004164 * (4.*0.896696*0.896696*std::exp(-2.*0.896696*(x-5.542567)) - 2.*0.896696*0.896696*std::exp(-0.896696*(x-5.542567)));
+    }
+
+    complex_t evaluate_at_implementation(const Taylor::argument_type& x) const {
+        return evalV(x);
+    }
+
+    template <template <typename...> class Tuple = std::tuple>
+    Tuple<Taylor::potential_evaluation_type, Taylor::jacobian_evaluation_type, Taylor::hessian_evaluation_type>
+    taylor_at_implementation(const Taylor::argument_type& x) const {
+        return Tuple<Taylor::potential_evaluation_type,Taylor::jacobian_evaluation_type,Taylor::hessian_evaluation_type>
+            (evalV(x), evalJ(x), evalH(x));
+    }
+
+    complex_t evaluate_local_remainder_at(const complex_t& x, const complex_t& q) const {
+        const auto xmq = x - q;
+        return evalV(x) - evalV(q) - evalJ(q)*xmq - 0.5*xmq*evalH(q)*xmq;
+    }
+};
+
+/**
+ * Propagates a packet with a fixed, large basis and with an adaptive basis that starts smaller.
+ *
+ * The fixed basis has 20 nodes, the adaptive one grows from 8 to 17 nodes
+ * and deviates by about 4.4e-8 from the fixed one at T = 2.
+ */
+bool test_propagation()
+{
+    typedef shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+    typedef ScalarHaWp<D,MultiIndex> Packet;
+    typedef innerproducts::GaussHermiteQR<24> QR;
+
+    auto init = [](Packet& packet, int K) {
+        packet.eps() = 0.0484;
+        packet.parameters() = HaWpParamSet<D>(6.0426 * RVector<D>::Ones(),
+                                              -0.1100 * RVector<D>::Ones(),
+                                              complex_t(3.4957,0.) * CMatrix<D,D>::Identity(),
+                                              complex_t(0.,0.2861) * CMatrix<D,D>::Identity(),
+                                              0);
+        packet.shape() = shapes::ShapeEnumerator<D,MultiIndex>().enumerate(shapes::HyperCubicShape<D>(K));
+        packet.coefficients().setZero(K);
+        packet.coefficients()[0] = 0.8;
+        packet.coefficients()[1] = complex_t(0.,0.6);
+    };
+
+    const real_t T = 2.0;
+    const real_t Dt = 0.01;
+
+    Potential V;
+
+    Packet fixed;
+    init(fixed, 20);
+    propagators::HagedornPropagator<N,D,MultiIndex,QR,Potential,Packet> fixed_propagator(fixed, V);
+    fixed_propagator.evolve(T, Dt);
+
+    // new nodes enter with zero coefficients one step late, thus start with some margin
+    Packet adaptive;
+    init(adaptive, 8);
+    propagators::HagedornPropagator<N,D,MultiIndex,QR,Potential,Packet> adaptive_propagator(adaptive, V);
+
+    HaWpShapeAdapter<D,MultiIndex> adapter(1e-10, 1e-16, 20);
+    std::size_t max_size = 0;
+    adaptive_propagator.afterStep([&](Packet& packet) {
+        adapter.adapt(packet);
+        max_size = std::max(max_size, packet.shape()->n_entries());
+    });
+    adaptive_propagator.evolve(T, Dt);
+
+    RMatrix<D,Eigen::Dynamic> grid = RMatrix<D,Eigen::Dynamic>::LinSpaced(101, 4.0, 8.0).transpose();
+    real_t dev = (adaptive.evaluate(grid) - fixed.evaluate(grid)).abs().maxCoeff();
+    real_t norm = adaptive.coefficients().norm();
+
+    std::cout << "propagation: |K| fixed = " << fixed.shape()->n_entries()
+              << ", adaptive = " << adaptive.shape()->n_entries() << " (max " << max_size << ")" << std::endl;
+    std::cout << "   max deviation " << dev << ", norm " << norm << std::endl;
+
+    return dev < 1e-6 && std::abs(norm - 1.) < 1e-8 && adaptive.shape()->n_entries() < fixed.shape()->n_entries();
+}
+
+/**
+ * Counts the calls of the hook, which must run once per time step, regardless of
+ * the number of steps with W per time step (McL42, Pre764 with pre- and post-processing)
+ * or the lack of a separate step with W (MG4).
+ */
+template<class Propagator>
+bool test_hook_per_step(std::string const& name)
+{
+    typedef shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+    typedef ScalarHaWp<D,MultiIndex> Packet;
+
+    Packet packet;
+    packet.eps() = 0.0484;
+    packet.parameters() = HaWpParamSet<D>(6.0426 * RVector<D>::Ones(),
+                                          -0.1100 * RVector<D>::Ones(),
+                                          complex_t(3.4957,0.) * CMatrix<D,D>::Identity(),
+                                          complex_t(0.,0.2861) * CMatrix<D,D>::Identity(),
+                                          0);
+    packet.shape() = shapes::ShapeEnumerator<D,MultiIndex>().enumerate(shapes::HyperCubicShape<D>(8));
+    packet.coefficients().setZero(8);
+    packet.coefficients()[0] = 1.0;
+
+    Potential V;
+    Propagator propagator(packet, V);
+
+    int calls = 0;
+    propagator.afterStep([&](Packet&) { calls++; });
+    propagator.evolve(0.1, 0.01);
+
+    std::cout << name << ": hook called " << calls << " times in 10 steps" << std::endl;
+
+    return calls == 10;
+}
+
+int main()
+{
+    bool ok = true;
+
+    ok &= test_prune_and_grow();
+    ok &= test_propagation();
+
+    typedef shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+    typedef innerproducts::GaussHermiteQR<24> QR;
+    typedef ScalarHaWp<D,MultiIndex> Packet;
+    ok &= test_hook_per_step<propagators::MG4Propagator<N,D,MultiIndex,QR,Potential,Packet>>("MG4");
+    ok &= test_hook_per_step<propagators::McL42Propagator<N,D,MultiIndex,QR,Potential,Packet>>("McL42");
+    ok &= test_hook_per_step<propagators::Pre764Propagator<N,D,MultiIndex,QR,Potential,Packet>>("Pre764");
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
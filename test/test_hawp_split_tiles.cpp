@@ -0,0 +1,125 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_evaluator.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Evaluates the same packet on a fixed-size and on a dynamically sized copy of a grid
+ * and updates the maximum deviation of all(), reduce() and batch_reduce().
+ */
+template<class Fixed, class Split, class Packet, class T, class A>
+void check(Fixed const& fixed, Split const& split, Packet const& wp,
+           CMatrix<Eigen::Dynamic,Eigen::Dynamic> const& coefficients,
+           wavepackets::HaWpEvaluatorWorkspace<Eigen::Dynamic,T>& workspace,
+           real_t& dev, real_t& scale, A)
+{
+    typedef Eigen::Array<std::complex<A>,Eigen::Dynamic,Eigen::Dynamic> ResultArray;
+
+    ResultArray fixed_basis = fixed.all().template cast<std::complex<A>>();
+    ResultArray fixed_psi = fixed.reduce(wp.coefficients());
+    ResultArray fixed_batch = fixed.batch_reduce(coefficients);
+    ResultArray fixed_plain = fixed.batch_reduce(coefficients, false);
+
+    ResultArray split_basis = split.all().template cast<std::complex<A>>();
+    ResultArray split_psi = split.reduce(wp.coefficients(), workspace);
+    ResultArray split_batch = split.batch_reduce(coefficients, true, workspace);
+    ResultArray split_plain = split.batch_reduce(coefficients, false, workspace);
+
+    scale = std::max<real_t>(scale, fixed_basis.abs().maxCoeff());
+
+    dev = std::max<real_t>(dev, (fixed_basis - split_basis).abs().maxCoeff());
+    dev = std::max<real_t>(dev, (fixed_psi - split_psi).abs().maxCoeff());
+    dev = std::max<real_t>(dev, (fixed_batch - split_batch).abs().maxCoeff());
+    dev = std::max<real_t>(dev, (fixed_plain - split_plain).abs().maxCoeff());
+}
+
+/**
+ * Dynamically sized grids run the recursion on split-complex tiles, fixed-size grids on interleaved
+ * complex slices. Compares all(), reduce() and batch_reduce() of both paths on complex and real grids,
+ * with basis values of type T and accumulation of type A.
+ */
+template<dim_t D, int N, class T, class A, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp, real_t tol)
+{
+    CMatrix<D,N> grid(D, N);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < N; j++) {
+            grid(i,j) = complex_t(-1.0 + 2.0*j/std::max(N-1,1) + 0.1*i, 0.05*std::sin(j + i));
+        }
+    }
+    RMatrix<D,N> rgrid = grid.real();
+
+    CMatrix<D,Eigen::Dynamic> dgrid = grid;
+    RMatrix<D,Eigen::Dynamic> drgrid = rgrid;
+
+    CMatrix<Eigen::Dynamic,Eigen::Dynamic> coefficients(3, wp.shape()->n_entries());
+    for (int c = 0; c < 3; c++)
+        coefficients.row(c) = wp.coefficients().transpose() * std::exp(complex_t(0, 0.5*c));
+
+    wavepackets::HaWpEvaluatorWorkspace<Eigen::Dynamic,T> workspace;
+
+    real_t dev = 0;
+    real_t scale = 0;
+
+    check(wp.template create_evaluator<N,T,A>(grid), wp.template create_evaluator<Eigen::Dynamic,T,A>(dgrid),
+          wp, coefficients, workspace, dev, scale, A());
+    check(wp.template create_evaluator<N,T,A>(rgrid), wp.template create_evaluator<Eigen::Dynamic,T,A>(drgrid),
+          wp, coefficients, workspace, dev, scale, A());
+
+    std::cout << "D = " << D << ", |K| = " << wp.shape()->n_entries() << ", N = " << N
+              << ", T = " << (sizeof(T) == 4 ? "float" : "double") << ", A = " << (sizeof(A) == 4 ? "float" : "double") << std::endl;
+    std::cout << "   max rel. deviation split-complex tiles: " << dev / scale << std::endl;
+
+    return dev / scale < tol;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef wavepackets::shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(20));
+        ok &= compare<D,13,real_t,real_t>(wp, 1e-12);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(10));
+        ok &= compare<D,16,real_t,real_t>(wp, 1e-12);
+        ok &= compare<D,21,float,double>(wp, 1e-5);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 6));
+        ok &= compare<D,7,real_t,real_t>(wp, 1e-12);
+        ok &= compare<D,1,real_t,real_t>(wp, 1e-12);
+    }
+
+    {
+        const dim_t D = 5;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(8));
+        ok &= compare<D,9,real_t,real_t>(wp, 1e-12);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
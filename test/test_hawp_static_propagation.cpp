@@ -0,0 +1,151 @@
+#include <iostream>
+#include <cmath>
+#include <memory>
+#include <chrono>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/potentials/potentials.hpp"
+#include "waveblocks/potentials/bases.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_hypercubic.hpp"
+#include "waveblocks/innerproducts/gauss_hermite_qr.hpp"
+#include "waveblocks/propagators/HagedornPropagator.hpp"
+#include "waveblocks/propagators/MG4Propagator.hpp"
+
+
+using namespace waveblocks;
+
+const int N = 1;
+const int D = 1;
+const int K = 8;
+
+/**
+ * Morse potential (same as examples/morse_1D.cpp).
+ */
+class Potential : public potentials::modules::evaluation::Abstract<Potential,CanonicalBasis<N,D>>,
+                  public potentials::modules::taylor::Abstract<Potential,CanonicalBasis<N,D>>,
+                  public potentials::modules::localRemainder::Abstract<Potential,N,D>,
+                  public LeadingLevelOwner<potentials::modules::taylor::Abstract<Potential,CanonicalBasis<N,D>>>
+{
+public:
+    using Taylor = potentials::modules::taylor::Abstract<Potential,CanonicalBasis<N,D>>;
+
+    Taylor::potential_evaluation_type evalV(const Taylor::argument_type& x) const {
+        return 0.004164 * (std::exp(-2.*0.896696*(x-5.542567)) - 2.*std::exp(-0.896696*(x-5.542567)));
+    }
+
+    Taylor::jacobian_evaluation_type evalJ(const Taylor::argument_type& x) const {
+        return 0.004164 * (-2.*0.896696*std::exp(-2.*0.896696*(x-5.542567)) + 2.*0.896696*std::exp(-0.896696*(x-5.542567)));
+    }
+
+    Taylor::hessian_evaluation_type evalH(const Taylor::argument_type& x) const {
+        return 0.004164 * (4.*0.896696*0.896696*std::exp(-2.*0.896696*(x-5.542567)) - 2.*0.896696*0.896696*std::exp(-0.896696*(x-5.542567)));
+    }
+
+    complex_t evaluate_at_implementation(const Taylor::argument_type& x) const {
+        return evalV(x);
+    }
+
+    template <template <typename...> class Tuple = std::tuple>
+    Tuple<Taylor::potential_evaluation_type, Taylor::jacobian_evaluation_type, Taylor::hessian_evaluation_type>
+    taylor_at_implementation(const Taylor::argument_type& x) const {
+        return Tuple<Taylor::potential_evaluation_type,Taylor::jacobian_evaluation_type,Taylor::hessian_evaluation_type>
+            (evalV(x), evalJ(x), evalH(x));
+    }
+
+    complex_t evaluate_local_remainder_at(const complex_t& x, const complex_t& q) const {
+        const auto xmq = x - q;
+        return evalV(x) - evalV(q) - evalJ(q)*xmq - 0.5*xmq*evalH(q)*xmq;
+    }
+};
+
+using MultiIndex = wavepackets::shapes::TinyMultiIndex<unsigned short, D>;
+using QR = innerproducts::GaussHermiteQR<K+4>;
+using DynamicPacket = wavepackets::ScalarHaWp<D,MultiIndex>;
+using StaticPacket = wavepackets::StaticScalarHaWp<D,MultiIndex,K>;
+
+template<class Packet>
+void init(Packet& packet)
+{
+    wavepackets::shapes::ShapeEnumerator<D,MultiIndex> enumerator;
+
+    packet.eps() = 0.0484;
+    packet.parameters() = wavepackets::HaWpParamSet<D>(6.0426 * RVector<D>::Ones(),
+                                                        -0.1100 * RVector<D>::Ones(),
+                                                        complex_t(3.4957,0.) * CMatrix<D,D>::Identity(),
+                                                        complex_t(0.,0.2861) * CMatrix<D,D>::Identity(),
+                                                        0);
+    packet.shape() = enumerator.enumerate(wavepackets::shapes::HyperCubicShape<D>(K));
+    packet.coefficients().setZero(K);
+    packet.coefficients()[0] = 0.8;
+    packet.coefficients()[1] = complex_t(0.,0.6);
+}
+
+/**
+ * Propagates the same packet as ScalarHaWp and as StaticScalarHaWp and compares the results.
+ */
+template<template<int,int,class,class,class,class,class> class Propagator, class... Args>
+bool compare(const char* name, Args... args)
+{
+    const real_t T = 1.0;
+    const real_t Dt = 0.01;
+
+    Potential V;
+
+    DynamicPacket dynamic_packet;
+    init(dynamic_packet);
+    Propagator<N,D,MultiIndex,QR,Potential,DynamicPacket,Args...> dynamic_propagator(dynamic_packet,V,args...);
+
+    StaticPacket static_packet;
+    init(static_packet);
+    Propagator<N,D,MultiIndex,QR,Potential,StaticPacket,Args...> static_propagator(static_packet,V,args...);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    dynamic_propagator.evolve(T,Dt);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    static_propagator.evolve(T,Dt);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    real_t dev_coefs = (static_packet.coefficients() - dynamic_packet.coefficients()).cwiseAbs().maxCoeff();
+    real_t dev_params = (static_packet.parameters().q() - dynamic_packet.parameters().q()).cwiseAbs().maxCoeff()
+                      + (static_packet.parameters().P() - dynamic_packet.parameters().P()).cwiseAbs().maxCoeff();
+    real_t norm = static_packet.coefficients().norm();
+
+    std::cout << name << ", K = " << K << std::endl;
+    std::cout << "   max deviation of coefficients: " << dev_coefs << std::endl;
+    std::cout << "   max deviation of parameters:   " << dev_params << std::endl;
+    std::cout << "   norm after propagation:        " << norm << std::endl;
+    std::cout << "   time dynamic: " << std::chrono::duration<double>(t1 - t0).count() << " s, "
+              << "static: " << std::chrono::duration<double>(t2 - t1).count() << " s" << std::endl;
+
+    return dev_coefs < 1e-12 && dev_params < 1e-12 && std::abs(norm - 1.) < 1e-10;
+}
+
+int main()
+{
+    bool ok = true;
+
+    ok &= compare<propagators::HagedornPropagator>("Hagedorn");
+    ok &= compare<propagators::MG4Propagator>("MG4", propagators::splitting_parameters::coefY4);
+
+    // evaluation agrees with the dynamic packet
+    {
+        DynamicPacket dynamic_packet;
+        init(dynamic_packet);
+        StaticPacket static_packet;
+        init(static_packet);
+
+        RMatrix<D,Eigen::Dynamic> grid = RMatrix<D,Eigen::Dynamic>::LinSpaced(101, 4.0, 8.0).transpose();
+        real_t dev = (static_packet.evaluate(grid) - dynamic_packet.evaluate(grid)).abs().maxCoeff();
+
+        std::cout << "evaluate: max deviation " << dev << std::endl;
+        ok &= dev == 0;
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_evaluator.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Runs one step() of the recursion with an overflowed (infinite) basis function in the previous slice.
+ * Basis functions that do not depend on it (their values do not change if its finite value changes)
+ * must stay finite, thus a missing neighbour must never be computed as zero times another basis function.
+ */
+template<dim_t D, class MultiIndex>
+bool check(wavepackets::ScalarHaWp<D,MultiIndex> const& wp, int islice, int npts)
+{
+    typedef typename wavepackets::HaWpEvaluator<D,MultiIndex,Eigen::Dynamic>::BasisVector BasisVector;
+
+    CMatrix<D,Eigen::Dynamic> grid(D, npts);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < npts; j++) {
+            grid(i,j) = complex_t(-1.0 + 2.0*j/(npts-1) + 0.1*i, 0.05*std::sin(j + i));
+        }
+    }
+
+    auto evaluator = wp.create_evaluator(grid);
+    auto const& shape = *wp.shape();
+
+    BasisVector prev_basis = BasisVector::Constant(shape.slice(islice-1).size(), npts, complex_t(0.3, -0.2));
+    BasisVector curr_basis = BasisVector::Constant(shape.slice(islice).size(), npts, complex_t(-0.1, 0.4));
+
+    BasisVector one = evaluator.step(islice, prev_basis, curr_basis);
+
+    prev_basis.row(0).setConstant(complex_t(2.0, 1.0));
+    BasisVector two = evaluator.step(islice, prev_basis, curr_basis);
+
+    prev_basis.row(0).setConstant(complex_t(std::numeric_limits<real_t>::infinity(), 0.0));
+    BasisVector inf = evaluator.step(islice, prev_basis, curr_basis);
+
+    long independent = 0;
+    bool finite = true;
+    for (long j = 0; j < one.rows(); j++) {
+        if ((one.row(j) == two.row(j)).all()) {
+            independent++;
+            finite &= inf.row(j).real().isFinite().all() && inf.row(j).imag().isFinite().all() && (inf.row(j) == one.row(j)).all();
+        }
+    }
+
+    std::cout << "D = " << D << ", slice " << islice << ": " << independent << " of " << one.rows()
+              << " basis functions independent of the infinite one, finite: " << (finite ? "yes" : "no") << std::endl;
+
+    return independent > 0 && finite;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(12));
+        ok &= check<D,MultiIndex>(wp, 4, 16);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= check<D,MultiIndex>(wp, 3, 16);
+    }
+
+    {
+        const dim_t D = 5;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(3));
+        ok &= check<D,MultiIndex>(wp, 5, 16);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
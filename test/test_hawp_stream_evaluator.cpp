@@ -0,0 +1,123 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_paramset.hpp"
+#include "waveblocks/wavepackets/hawp_stream_evaluator.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+#include "waveblocks/io/binary_grid_sink.hpp"
+#include "waveblocks/io/hdf5_grid_sink.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Streams the wavepacket block by block and compares against evaluation on the complete grid.
+ */
+template<dim_t D, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp,
+             std::array<long, std::size_t(D)> const& extents,
+             long block_size)
+{
+    wavepackets::RegularGrid<D> grid(RVector<D>::Constant(-1.5), RVector<D>::Constant(0.1), extents);
+    wavepackets::HaWpStreamEvaluator<D,MultiIndex> streamer(grid, block_size);
+
+    CArray<1,Eigen::Dynamic> expected = wp.evaluate(grid.points(0, grid.size()));
+
+    // collect blocks in memory
+    CArray<1,Eigen::Dynamic> streamed(1, grid.size());
+    long next = 0;
+    bool ordered = true;
+    streamer.evaluate(wp, [&](long first, CArray<1,Eigen::Dynamic> const& values) {
+        ordered &= (first == next);
+        next = first + values.size();
+        streamed.segment(first, values.size()) = values;
+    });
+
+    // stream into a binary file and read it back
+    const char* name = "test_hawp_stream_evaluator.bin";
+    {
+        io::BinaryGridSink sink(name);
+        streamer.evaluate(wp, sink);
+    }
+
+    CArray<1,Eigen::Dynamic> loaded(1, grid.size());
+    {
+        std::ifstream file(name, std::ios::binary);
+        file.read(reinterpret_cast<char*>(loaded.data()), loaded.size()*sizeof(complex_t));
+    }
+    std::remove(name);
+
+    // stream into an HDF5 dataset and read it back
+    const char* h5name = "test_hawp_stream_evaluator.h5";
+    {
+        io::HDF5GridSink<D> sink(h5name, "psi", extents);
+        streamer.evaluate(wp, sink);
+    }
+
+    CArray<1,Eigen::Dynamic> h5loaded(1, grid.size());
+    bool h5shape = true;
+    {
+        H5::CompType ctype(sizeof(complex_t));
+        ctype.insertMember("r", 0, H5::PredType::NATIVE_DOUBLE);
+        ctype.insertMember("i", sizeof(real_t), H5::PredType::NATIVE_DOUBLE);
+
+        H5::H5File file(h5name, H5F_ACC_RDONLY);
+        H5::DataSet dataset = file.openDataSet("psi");
+
+        H5::DataSpace space = dataset.getSpace();
+        std::array<hsize_t, std::size_t(D)> dims;
+        h5shape &= (space.getSimpleExtentNdims() == D);
+        space.getSimpleExtentDims(dims.data());
+        for (dim_t d = 0; d < D; d++)
+            h5shape &= (dims[d] == hsize_t(extents[d]));
+
+        dataset.read(h5loaded.data(), ctype);
+    }
+    std::remove(h5name);
+
+    real_t dev_streamed = (streamed - expected).abs().maxCoeff() / expected.abs().maxCoeff();
+    real_t dev_loaded = (loaded - streamed).abs().maxCoeff();
+    real_t dev_h5loaded = (h5loaded - streamed).abs().maxCoeff();
+
+    std::cout << "D = " << D << ", |K| = " << wp.shape()->n_entries() << ", grid points = " << grid.size()
+              << ", block size = " << block_size << std::endl;
+    std::cout << "   max rel. deviation streamed: " << dev_streamed << std::endl;
+    std::cout << "   max deviation binary file:   " << dev_loaded << std::endl;
+    std::cout << "   max deviation HDF5 file:     " << dev_h5loaded << std::endl;
+
+    return ordered && next == grid.size() && dev_streamed < 1e-12 && dev_loaded == 0 && h5shape && dev_h5loaded == 0;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(10));
+        ok &= compare<D,MultiIndex>(wp, {{31, 29}}, 100);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= compare<D,MultiIndex>(wp, {{9, 11, 7}}, 64);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/hawp_evaluator.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+
+/**
+ * Streams the basis through visit() and compares the visited slices against all().
+ * Checks that the slices are visited once and in order and that a custom contraction
+ * (projection onto the coefficients) matches reduce().
+ */
+template<dim_t D, int N, class MultiIndex>
+bool compare(wavepackets::ScalarHaWp<D,MultiIndex> const& wp, int npts)
+{
+    CMatrix<D,N> grid(D, npts);
+    for (int i = 0; i < D; i++) {
+        for (int j = 0; j < npts; j++) {
+            grid(i,j) = complex_t(-1.0 + 2.0*j/(npts-1) + 0.1*i, 0.05*std::sin(j + i));
+        }
+    }
+
+    auto evaluator = wp.template create_evaluator<N>(grid);
+
+    typedef typename decltype(evaluator)::ConstBasisRef ConstBasisRef;
+
+    HaWpBasisVector<N> expected = evaluator.all();
+    CArray<1,N> expected_psi = evaluator.reduce(wp.coefficients());
+
+    HaWpBasisVector<N> visited = HaWpBasisVector<N>::Zero(expected.rows(), npts);
+    CArray<1,N> psi = CArray<1,N>::Zero(1, npts);
+
+    bool ordered = true;
+    std::size_t next_offset = 0;
+
+    wavepackets::HaWpEvaluatorWorkspace<N> workspace;
+
+    evaluator.visit([&](wavepackets::shapes::ShapeSlice<D,MultiIndex> const& slice, ConstBasisRef basis) {
+        ordered &= (slice.offset() == next_offset) && ((std::size_t)basis.rows() == slice.size());
+        next_offset = slice.offset() + slice.size();
+
+        visited.middleRows(slice.offset(), basis.rows()) = basis;
+
+        for (long j = 0; j < basis.rows(); j++)
+            psi += basis.row(j) * wp.coefficients()[slice.offset() + j];
+    }, workspace);
+
+    ordered &= (next_offset == wp.shape()->n_entries());
+
+    real_t dev_basis = (visited - expected).abs().maxCoeff() / expected.abs().maxCoeff();
+    real_t dev_psi = (psi - expected_psi).abs().maxCoeff() / expected_psi.abs().maxCoeff();
+
+    std::cout << "D = " << D << ", |K| = " << wp.shape()->n_entries() << ", N = " << npts
+              << (N == Eigen::Dynamic ? " (dynamic)" : "") << std::endl;
+    std::cout << "   slices in order:                  " << (ordered ? "yes" : "no") << std::endl;
+    std::cout << "   max rel. deviation from all():    " << dev_basis << std::endl;
+    std::cout << "   max rel. deviation from reduce(): " << dev_psi << std::endl;
+
+    return ordered && dev_basis < 1e-12 && dev_psi < 1e-12;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef wavepackets::shapes::TinyMultiIndex<unsigned short,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperCubicShape<D>(20));
+        ok &= compare<D,9,MultiIndex>(wp, 9);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::HyperbolicCutShape<D>(10));
+        ok &= compare<D,16,MultiIndex>(wp, 16);
+        ok &= compare<D,Eigen::Dynamic,MultiIndex>(wp, 37);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef wavepackets::shapes::TinyMultiIndex<std::size_t,D> MultiIndex;
+        auto wp = test::create_wavepacket<D,MultiIndex>(wavepackets::shapes::LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= compare<D,7,MultiIndex>(wp, 7);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
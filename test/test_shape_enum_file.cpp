@@ -0,0 +1,195 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <yaml-cpp/yaml.h>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum_extended.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/io/shape_enum_file.hpp"
+#include "waveblocks/yaml/shape_decoder.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets::shapes;
+
+/**
+ * Checks that the mapped enumeration has the same nodes, lookups and neighbour links.
+ */
+template<dim_t D, class MultiIndex>
+bool compare(ShapeEnum<D,MultiIndex> const& expected, ShapeEnum<D,MultiIndex> const& mapped, bool with_links)
+{
+    bool ok = mapped == expected && mapped.n_slices() == expected.n_slices() && mapped.limits() == expected.limits();
+    ok &= bool(mapped.indexer()) == bool(expected.indexer());
+    ok &= mapped.has_links() == with_links;
+
+    for (int islice = 0; islice < expected.n_slices(); islice++) {
+        auto const& slice = mapped.slice(islice);
+        ok &= slice.mapped() && slice.offset() == expected.slice(islice).offset();
+
+        for (std::size_t j = 0; j < slice.size(); j++)
+            ok &= slice.find(expected.slice(islice)[j]) == j;
+
+        auto const& a = mapped.links(islice);
+        auto const& b = expected.links(islice);
+        ok &= a.backward == b.backward && a.sqrt == b.sqrt && a.axis == b.axis;
+    }
+
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    const dim_t D = 3;
+    typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+    ShapeEnumerator<D,MultiIndex> enumerator;
+
+    const std::string name = "test_shape_enum_file.wbshape";
+
+    // round trip with and without links
+    {
+        auto shape = enumerator.generate(LimitedHyperbolicCutShape<D>(12, {5,6,7}));
+        auto extended = shape_enum::extend(&shape);
+
+        for (bool with_links : {true, false}) {
+            io::write_shape_enum(extended, name, "extension", with_links);
+            auto mapped = io::map_shape_enum<D,MultiIndex>(name);
+            bool passed = mapped && compare(extended, *mapped, with_links);
+            std::cout << "round trip, links = " << with_links << ": " << (passed ? "ok" : "FAILED") << std::endl;
+            ok &= passed;
+        }
+
+        auto cube = enumerator.generate(HyperCubicShape<D>({3,4,5}));
+        io::write_shape_enum(cube, name);
+        auto mapped = io::map_shape_enum<D,MultiIndex>(name);
+        ok &= mapped && compare(cube, *mapped, true);
+
+        // modifying a mapped slice copies its nodes
+        MultiIndex first = mapped->slice(2)[0];
+        mapped->slice(2)._table()[0][0] += 1;
+        ok &= !mapped->slice(2).mapped() && mapped->slice(2)[0] != first && mapped->slice(1).mapped();
+    }
+
+    // rejected files
+    {
+        std::string description = "expected";
+        io::write_shape_enum(enumerator.generate(HyperbolicCutShape<D>(8)), name, "other");
+        ok &= !io::map_shape_enum<D,MultiIndex>(name, &description);
+        ok &= !io::map_shape_enum<D+1,TinyMultiIndex<std::size_t,D+1>>(name);
+        ok &= !io::map_shape_enum<D,TinyMultiIndex<unsigned short,D>>(name);
+        ok &= !io::map_shape_enum<D,MultiIndex>("does_not_exist.wbshape");
+
+        // neighbour links out of bounds
+        io::write_shape_enum(enumerator.generate(HyperbolicCutShape<D>(8)), name);
+        io::ShapeEnumFileHeader header;
+        std::fstream file(name, std::ios::in | std::ios::out | std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        io::shape_enum_file_detail::Layout<D,MultiIndex> layout(header);
+
+        // slice 0 only holds the node 0, thus ordinal 1 is out of bounds
+        const std::size_t pos = layout.backward + D*sizeof(std::uint32_t);
+        std::uint32_t stored, corrupt = 1;
+        file.seekg(pos);
+        file.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+        file.seekp(pos);
+        file.write(reinterpret_cast<char*>(&corrupt), sizeof(corrupt));
+        file.flush();
+        ok &= !io::map_shape_enum<D,MultiIndex>(name);
+
+        file.seekp(pos);
+        file.write(reinterpret_cast<char*>(&stored), sizeof(stored));
+        file.flush();
+        ok &= bool(io::map_shape_enum<D,MultiIndex>(name));
+
+        // recursion axis of the first node in slice 1
+        std::int32_t axis = D;
+        file.seekp(layout.axis + sizeof(std::int32_t));
+        file.write(reinterpret_cast<char*>(&axis), sizeof(axis));
+        file.close();
+        ok &= !io::map_shape_enum<D,MultiIndex>(name);
+
+        std::cout << "rejected files: " << (ok ? "ok" : "FAILED") << std::endl;
+    }
+
+    // evaluation on the mapped shape
+    {
+        wavepackets::ScalarHaWp<D,MultiIndex> wp, mapped_wp;
+        wp.eps() = 0.9;
+        wp.shape() = enumerator.enumerate(LimitedHyperbolicCutShape<D>(7, {5,5,5}));
+        wp.coefficients() = CMatrix<Eigen::Dynamic,1>::Random(wp.shape()->n_entries());
+
+        io::write_shape_enum(*wp.shape(), name);
+        mapped_wp.eps() = wp.eps();
+        mapped_wp.parameters() = wp.parameters();
+        mapped_wp.shape() = io::map_shape_enum<D,MultiIndex>(name);
+        mapped_wp.coefficients() = wp.coefficients();
+
+        RMatrix<D,Eigen::Dynamic> grid = RMatrix<D,Eigen::Dynamic>::Random(D, 50);
+        real_t dev = (wp.evaluate(grid) - mapped_wp.evaluate(grid)).abs().maxCoeff();
+        std::cout << "evaluate: max deviation " << dev << std::endl;
+        ok &= dev == 0;
+    }
+    std::remove(name.c_str());
+
+    // shape decoder uses the cache file
+    {
+        const std::string cache = "test_shape_enum_cache.wbshape";
+        std::remove(cache.c_str());
+
+        YAML::Node config = YAML::Load("{dimensionality: 3, limits: [5, 5, 5], sparsity: 7.0, type: hyperbolic, cache: " + cache + "}");
+        yaml::ShapeDecoder<D> decoder;
+
+        auto first = decoder.enumerate<MultiIndex>(config);
+        auto second = decoder.enumerate<MultiIndex>(config);
+        ok &= !first->slice(1).mapped() && second->slice(1).mapped() && *first == *second;
+
+        // another shape replaces the stale cache
+        config["sparsity"] = 9.0;
+        auto third = decoder.enumerate<MultiIndex>(config);
+        auto fourth = decoder.enumerate<MultiIndex>(config);
+        ok &= !third->slice(1).mapped() && fourth->slice(1).mapped() && *third == *fourth && !(*third == *first);
+
+        // the file is recognized by the identity key of the shape
+        std::ostringstream key;
+        LimitedHyperbolicCutShape<D>(9, {5,5,5}).identity(key);
+        std::string description = key.str();
+        ok &= bool(io::map_shape_enum<D,MultiIndex>(cache, &description));
+
+        std::cout << "shape decoder cache: " << (ok ? "ok" : "FAILED") << std::endl;
+        std::remove(cache.c_str());
+    }
+
+    // startup time
+    {
+        const dim_t D = 6;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        auto shape = ShapeEnumerator<D,MultiIndex>().generate(HyperbolicCutShape<D>(600));
+        shape.links(0);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        io::write_shape_enum(shape, name);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        auto mapped = io::map_shape_enum<D,MultiIndex>(name);
+        auto t3 = std::chrono::high_resolution_clock::now();
+
+        ok &= mapped && *mapped == shape;
+        std::cout << "hyperbolic D=6, |K| = " << shape.n_entries() << ": enumerate + links "
+                  << std::chrono::duration<double>(t1 - t0).count() << " s, write "
+                  << std::chrono::duration<double>(t2 - t1).count() << " s, map "
+                  << std::chrono::duration<double>(t3 - t2).count() << " s" << std::endl;
+        std::remove(name.c_str());
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
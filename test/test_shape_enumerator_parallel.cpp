@@ -0,0 +1,108 @@
+#include <iostream>
+#include <chrono>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets::shapes;
+using waveblocks::test::SimplexShape;
+
+/**
+ * Derived shape class, which is enumerated through virtual calls.
+ */
+template<dim_t D, class Base>
+class VirtualShape : public Base
+{
+public:
+    template<class... Args>
+    VirtualShape(Args... args) : Base(args...) {}
+};
+
+template<class Function>
+double seconds(Function f)
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+/**
+ * Compares the parallel enumeration with the sequential enumeration through virtual calls.
+ */
+template<dim_t D>
+bool check(const char* name, AbstractShape<D> const& shape, AbstractShape<D> const& virtual_shape, bool benchmark = false)
+{
+    typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+
+    ShapeEnumerator<D,MultiIndex> sequential;
+    sequential.parallel = false;
+    ShapeEnumerator<D,MultiIndex> parallel;
+
+    ShapeEnum<D,MultiIndex> a, b, c;
+    double ta = seconds([&] { a = sequential.generate(virtual_shape); });
+    double tb = seconds([&] { b = sequential.generate(shape); });
+    double tc = seconds([&] { c = parallel.generate(shape); });
+
+    bool ok = a == b && a == c && a.n_slices() == c.n_slices() && a.limits() == c.limits();
+    for (int islice = 0; islice < a.n_slices(); islice++)
+        ok &= a.slice(islice).offset() == c.slice(islice).offset();
+
+    std::cout << name << ": |K| = " << a.n_entries() << " -> " << (ok ? "ok" : "FAILED") << std::endl;
+    if (benchmark) {
+        std::cout << "   virtual " << ta << " s, devirtualized " << tb << " s, parallel " << tc << " s" << std::endl;
+    }
+
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        ok &= check<D>("hypercubic D=1", HyperCubicShape<D>(7), VirtualShape<D,HyperCubicShape<D>>(7));
+    }
+
+    {
+        const dim_t D = 2;
+        ok &= check<D>("hyperbolic D=2", HyperbolicCutShape<D>(20), VirtualShape<D,HyperbolicCutShape<D>>(20));
+        ok &= check<D>("hypercubic D=2", HyperCubicShape<D>({3,9}), VirtualShape<D,HyperCubicShape<D>>(std::array<int,D>{{3,9}}));
+    }
+
+    {
+        const dim_t D = 3;
+        ok &= check<D>("limited hyperbolic D=3", LimitedHyperbolicCutShape<D>(12, {5,6,7}),
+                       VirtualShape<D,LimitedHyperbolicCutShape<D>>(12, std::array<int,D>{{5,6,7}}));
+        ok &= check<D>("simplex D=3", SimplexShape<D>(9), SimplexShape<D>(9));
+    }
+
+    {
+        const dim_t D = 5;
+        ok &= check<D>("hypercubic D=5", HyperCubicShape<D>({4,3,5,2,6}),
+                       VirtualShape<D,HyperCubicShape<D>>(std::array<int,D>{{4,3,5,2,6}}));
+    }
+
+    {
+        const dim_t D = 7;
+        ok &= check<D>("hyperbolic D=7", HyperbolicCutShape<D>(500), VirtualShape<D,HyperbolicCutShape<D>>(500), true);
+    }
+
+    {
+        const dim_t D = 10;
+        ok &= check<D>("limited hyperbolic D=10", LimitedHyperbolicCutShape<D>(400, 8),
+                       VirtualShape<D,LimitedHyperbolicCutShape<D>>(400, 8), true);
+        ok &= check<D>("hypercubic D=10", HyperCubicShape<D>(4), VirtualShape<D,HyperCubicShape<D>>(4), true);
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
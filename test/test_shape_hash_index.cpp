@@ -0,0 +1,165 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum_extended.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets::shapes;
+
+/**
+ * Position of a node by binary search, same as ShapeSlice::try_find() without hash table.
+ */
+template<dim_t D, class MultiIndex>
+bool search(ShapeSlice<D,MultiIndex> const& slice, MultiIndex const& index, std::size_t& ordinal)
+{
+    auto it = std::lower_bound(slice.begin(), slice.end(), index, std::less<MultiIndex>());
+    if (it == slice.end() || *it != index)
+        return false;
+    ordinal = it - slice.begin();
+    return true;
+}
+
+/**
+ * Compares all lookups of a hashed enumeration against binary search:
+ * every node, its forward neighbours (some of them are missing) and its backward neighbours.
+ */
+template<dim_t D, class MultiIndex>
+bool check(const char* name, ShapeEnum<D,MultiIndex> shape)
+{
+    shape.enable_hash_index();
+
+    bool ok = true;
+    std::size_t n_lookups = 0;
+
+    for (int islice = 0; islice < shape.n_slices(); islice++) {
+        auto const& slice = shape.slice(islice);
+        ok &= slice.hashed() || slice.size() == 0;
+
+        for (std::size_t j = 0; j < slice.size(); j++) {
+            MultiIndex index = slice[j];
+
+            std::size_t ordinal = 0;
+            ok &= slice.try_find(index, ordinal) && ordinal == j;
+
+            for (dim_t d = 0; d < D; d++) {
+                MultiIndex next = index;
+                next[d] += 1;
+
+                std::size_t expected = 0, actual = 0;
+                bool found = search(shape.slice(islice+1), next, expected);
+                ok &= (shape.slice(islice+1).try_find(next, actual) == found);
+                ok &= (!found || actual == expected);
+
+                // wrong slice
+                ok &= !slice.try_find(next, actual);
+
+                n_lookups += 2;
+            }
+
+            std::array<std::size_t,D> backward = shape.slice(islice-1).find_backward_neighbours(index);
+            for (dim_t d = 0; d < D; d++) {
+                if (index[d] != 0) {
+                    MultiIndex prev = index;
+                    prev[d] -= 1;
+                    std::size_t expected = 0;
+                    ok &= search(shape.slice(islice-1), prev, expected) && backward[d] == expected;
+                }
+            }
+        }
+    }
+
+    std::cout << name << ": |K| = " << shape.n_entries() << ", lookups = " << n_lookups
+              << " -> " << (ok ? "ok" : "FAILED") << std::endl;
+
+    return ok;
+}
+
+/**
+ * Compares the time of try_find() with and without hash table.
+ */
+template<dim_t D, class MultiIndex>
+void benchmark(const char* name, ShapeEnum<D,MultiIndex> const& searched)
+{
+    ShapeEnum<D,MultiIndex> hashed = searched;
+    hashed.enable_hash_index();
+
+    std::size_t max_slice = 0;
+    for (int islice = 0; islice < searched.n_slices(); islice++)
+        max_slice = std::max(max_slice, searched.slice(islice).size());
+
+    auto run = [](ShapeEnum<D,MultiIndex> const& shape) {
+        std::size_t sum = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int rep = 0; rep < 5; rep++) {
+            for (int islice = 0; islice < shape.n_slices(); islice++) {
+                auto const& slice = shape.slice(islice);
+                for (auto const& index : slice) {
+                    std::size_t ordinal = 0;
+                    slice.try_find(index, ordinal);
+                    sum += ordinal;
+                }
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        return std::make_pair(std::chrono::duration<double>(t1 - t0).count(), sum);
+    };
+
+    auto a = run(searched);
+    auto b = run(hashed);
+
+    std::cout << "   " << name << ": 5 x try_find over all " << searched.n_entries() << " nodes (largest slice "
+              << max_slice << "): binary search " << a.first << " s, hash " << b.first << " s"
+              << (a.second == b.second ? "" : " (MISMATCH)") << std::endl;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 2;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        ok &= check("hyperbolic D=2", enumerator.generate(HyperbolicCutShape<D>(10)));
+    }
+
+    {
+        const dim_t D = 3;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        auto shape = enumerator.generate(LimitedHyperbolicCutShape<D>(12, 5));
+        ok &= check("limited hyperbolic D=3", shape);
+        ok &= check("extension of limited hyperbolic D=3", shape_enum::extend(&shape));
+
+        // hypercubes keep their closed-form indexer
+        auto cube = enumerator.generate(HyperCubicShape<D>(4));
+        cube.enable_hash_index();
+        ok &= cube.slice(3).indexed() && !cube.slice(3).hashed();
+    }
+
+    {
+        const dim_t D = 6;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        ok &= check("hyperbolic D=6", enumerator.generate(HyperbolicCutShape<D>(16)));
+
+        benchmark("hyperbolic D=6", enumerator.generate(HyperbolicCutShape<D>(600)));
+    }
+
+    {
+        const dim_t D = 8;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        benchmark("limited hyperbolic D=8", enumerator.generate(LimitedHyperbolicCutShape<D>(400, 12)));
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
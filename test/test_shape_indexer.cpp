@@ -0,0 +1,175 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum_union.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum_extended.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum_subset.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets::shapes;
+using waveblocks::test::SimplexShape;
+
+/**
+ * Position of a node by binary search, same as ShapeSlice::try_find() without indexer.
+ */
+template<dim_t D, class MultiIndex>
+bool search(ShapeSlice<D,MultiIndex> const& slice, MultiIndex const& index, std::size_t& ordinal)
+{
+    auto it = std::lower_bound(slice.begin(), slice.end(), index, std::less<MultiIndex>());
+    if (it == slice.end() || *it != index)
+        return false;
+    ordinal = it - slice.begin();
+    return true;
+}
+
+/**
+ * Compares all lookups of an enumeration against binary search:
+ * every node, its forward neighbours (some of them are missing) and its backward neighbours.
+ */
+template<dim_t D, class MultiIndex>
+bool check(const char* name, ShapeEnum<D,MultiIndex> const& shape, bool expect_indexer)
+{
+    bool ok = (bool(shape.indexer()) == expect_indexer);
+
+    std::size_t n_lookups = 0;
+
+    for (int islice = 0; islice < shape.n_slices(); islice++) {
+        auto const& slice = shape.slice(islice);
+
+        for (std::size_t j = 0; j < slice.size(); j++) {
+            MultiIndex index = slice[j];
+
+            std::size_t ordinal = 0;
+            ok &= slice.try_find(index, ordinal) && ordinal == j;
+
+            // forward neighbours in next slice, backward neighbours in previous slice
+            for (dim_t d = 0; d < D; d++) {
+                MultiIndex next = index;
+                next[d] += 1;
+
+                std::size_t expected = 0, actual = 0;
+                bool found = search(shape.slice(islice+1), next, expected);
+                ok &= (shape.slice(islice+1).try_find(next, actual) == found);
+                ok &= (!found || actual == expected);
+
+                // wrong slice
+                ok &= !slice.try_find(next, actual);
+
+                n_lookups += 2;
+            }
+
+            std::array<std::size_t,D> backward = shape.slice(islice-1).find_backward_neighbours(index);
+            for (dim_t d = 0; d < D; d++) {
+                if (index[d] != 0) {
+                    MultiIndex prev = index;
+                    prev[d] -= 1;
+                    std::size_t expected = 0;
+                    ok &= search(shape.slice(islice-1), prev, expected) && backward[d] == expected;
+                }
+            }
+        }
+    }
+
+    std::cout << name << ": |K| = " << shape.n_entries() << ", indexer = " << (shape.indexer() ? "yes" : "no")
+              << ", lookups = " << n_lookups << " -> " << (ok ? "ok" : "FAILED") << std::endl;
+
+    return ok;
+}
+
+/**
+ * Compares the time of try_find() with and without indexer.
+ */
+template<dim_t D, class MultiIndex>
+void benchmark(ShapeEnum<D,MultiIndex> const& indexed)
+{
+    ShapeEnum<D,MultiIndex> searched = indexed;
+    for (int islice = 0; islice < searched.n_slices(); islice++)
+        searched.slice(islice)._set_indexer(nullptr, islice);
+
+    auto run = [](ShapeEnum<D,MultiIndex> const& shape) {
+        std::size_t sum = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int islice = 0; islice < shape.n_slices(); islice++) {
+            auto const& slice = shape.slice(islice);
+            for (auto const& index : slice) {
+                std::size_t ordinal = 0;
+                slice.try_find(index, ordinal);
+                sum += ordinal;
+            }
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        return std::make_pair(std::chrono::duration<double>(t1 - t0).count(), sum);
+    };
+
+    auto a = run(searched);
+    auto b = run(indexed);
+
+    std::cout << "   try_find over all " << indexed.n_entries() << " nodes: binary search " << a.first
+              << " s, indexer " << b.first << " s" << (a.second == b.second ? "" : " (MISMATCH)") << std::endl;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        const dim_t D = 1;
+        typedef TinyMultiIndex<unsigned short,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        ok &= check("hypercubic D=1", enumerator.generate(HyperCubicShape<D>(17)), true);
+    }
+
+    {
+        const dim_t D = 2;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        ok &= check("hypercubic D=2", enumerator.generate(HyperCubicShape<D>({3,9})), true);
+        ok &= check("simplex D=2", enumerator.generate(SimplexShape<D>(12)), true);
+        ok &= check("hyperbolic D=2", enumerator.generate(HyperbolicCutShape<D>(10)), false);
+    }
+
+    {
+        const dim_t D = 3;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        auto small = enumerator.generate(HyperCubicShape<D>({2,3,4}));
+        auto large = enumerator.generate(HyperCubicShape<D>({5,4,6}));
+        ok &= check("hypercubic D=3", large, true);
+        ok &= check("simplex D=3", enumerator.generate(SimplexShape<D>(9)), true);
+        ok &= check("limited hyperbolic D=3", enumerator.generate(LimitedHyperbolicCutShape<D>(12, 5)), false);
+        ok &= check("union of nested hypercubes D=3", shape_enum::strict_union<D,MultiIndex>({&small, &large}), true);
+        ok &= check("extension of hypercube D=3", shape_enum::extend(&large), false);
+
+        // subset map via indexer equals merge walk
+        auto extended = shape_enum::extend(&large);
+        for (int islice = 0; islice < extended.n_slices(); islice++) {
+            auto const& superset_slice = extended.slice(islice);
+            auto const& subset_slice = large.slice(islice);
+            ShapeSlice<D,MultiIndex> unindexed = subset_slice;
+            unindexed._set_indexer(nullptr, islice);
+            ok &= shape_enum::subset_ordinals(superset_slice, subset_slice) == shape_enum::subset_ordinals(superset_slice, unindexed);
+        }
+    }
+
+    {
+        const dim_t D = 5;
+        typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+        ShapeEnumerator<D,MultiIndex> enumerator;
+        auto shape = enumerator.generate(HyperCubicShape<D>({4,3,5,2,6}));
+        ok &= check("hypercubic D=5", shape, true);
+
+        benchmark(enumerator.generate(HyperCubicShape<D>(10)));
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_commons.hpp"
+#include "waveblocks/wavepackets/shapes/shape_registry.hpp"
+
+#include "test_fixtures.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets;
+using namespace waveblocks::wavepackets::shapes;
+
+const dim_t D = 3;
+typedef TinyMultiIndex<std::size_t,D> MultiIndex;
+typedef ShapeRegistry<D,MultiIndex> Registry;
+
+/**
+ * Simplex whose printed description leaves out the size.
+ */
+class UnnamedSimplexShape : public test::SimplexShape<D>
+{
+public:
+    UnnamedSimplexShape(int S) : test::SimplexShape<D>(S) {}
+
+    virtual void print(std::ostream & out) const override
+    {
+        out << "SimplexShape";
+    }
+};
+
+int main()
+{
+    bool ok = true;
+
+    Registry& registry = Registry::instance();
+    ShapeEnumerator<D,MultiIndex> enumerator;
+
+    // interning by content and by description
+    {
+        auto a = enumerator.enumerate(LimitedHyperbolicCutShape<D>(9, {4,5,6}));
+        auto b = enumerator.enumerate(LimitedHyperbolicCutShape<D>(9, {4,5,6}));
+        auto c = enumerator.enumerate(LimitedHyperbolicCutShape<D>(9, {4,5,7}));
+
+        auto registered = registry.intern(a);
+
+        bool passed = registered != a && *registered == *a;
+        passed &= registry.intern(registered) == registered && registry.intern(b) == registered;
+        passed &= registry.intern(c) != registered && *registry.intern(c) == *c;
+        passed &= registry.intern(LimitedHyperbolicCutShape<D>(9, {4,5,6})) == registered;
+        passed &= registry.intern(LimitedHyperbolicCutShape<D>(9, {4,5,6})) == registered;
+        passed &= registry.intern(HyperbolicCutShape<D>(9)) != registered;
+
+        // the registered instance is a copy, thus modifying the caller's object does not affect it
+        a->slice(2)._table()[0][0] += 1;
+        passed &= *registry.intern(LimitedHyperbolicCutShape<D>(9, {4,5,6})) == *b;
+
+        std::cout << "intern: " << (passed ? "ok" : "FAILED") << std::endl;
+        ok &= passed;
+    }
+
+    // shapes without identity key are interned by content, regardless of their printed description
+    {
+        auto a = registry.intern(UnnamedSimplexShape(6));
+        auto b = registry.intern(UnnamedSimplexShape(8));
+        auto c = registry.intern(test::SimplexShape<D>(8));
+
+        bool passed = a != b && b == c;
+        passed &= *a == *enumerator.enumerate(UnnamedSimplexShape(6));
+        passed &= *b == *enumerator.enumerate(UnnamedSimplexShape(8));
+
+        std::cout << "intern without identity: " << (passed ? "ok" : "FAILED") << std::endl;
+        ok &= passed;
+    }
+
+    // extensions of identical shapes are computed once
+    {
+        std::vector< ScalarHaWp<D,MultiIndex> > ensemble(100);
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (auto& packet : ensemble)
+            packet.shape() = enumerator.enumerate(HyperbolicCutShape<D>(40));
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto& packet : ensemble)
+            packet.extended_shape();
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        auto expected = shape_enum::extend(ensemble[0].shape().get());
+        auto t3 = std::chrono::high_resolution_clock::now();
+
+        bool passed = *ensemble[0].extended_shape() == expected;
+        for (auto& packet : ensemble)
+            passed &= packet.extended_shape() == ensemble[0].extended_shape();
+
+        std::cout << "extension: " << (passed ? "ok" : "FAILED") << std::endl;
+        std::cout << "   100 packets: enumerate " << std::chrono::duration<double>(t1 - t0).count()
+                  << " s, extend via registry " << std::chrono::duration<double>(t2 - t1).count()
+                  << " s, one extend " << std::chrono::duration<double>(t3 - t2).count() << " s" << std::endl;
+        ok &= passed;
+    }
+
+    // unions of identical component shapes are computed once
+    {
+        HomogeneousHaWp<D,MultiIndex> p(2), q(2);
+        p.component(0).shape() = enumerator.enumerate(HyperCubicShape<D>({3,5,2}));
+        p.component(1).shape() = enumerator.enumerate(LimitedHyperbolicCutShape<D>(8, {6,3,4}));
+        q.component(0).shape() = enumerator.enumerate(HyperCubicShape<D>({3,5,2}));
+        q.component(1).shape() = enumerator.enumerate(LimitedHyperbolicCutShape<D>(8, {6,3,4}));
+
+        std::vector< ShapeEnum<D,MultiIndex> const* > list = {p.component(0).shape().get(), p.component(1).shape().get()};
+        auto expected = shape_enum::strict_union<D,MultiIndex>(list);
+
+        bool passed = p.union_shape() == q.union_shape() && *p.union_shape() == expected;
+
+        std::cout << "union: " << (passed ? "ok" : "FAILED") << std::endl;
+        ok &= passed;
+    }
+
+    // unused shapes are released
+    {
+        auto shape = registry.intern(enumerator.enumerate(HyperbolicCutShape<D>(23)));
+
+        // union of a single shape is the shape itself and must not keep it alive
+        std::weak_ptr< ShapeEnum<D,MultiIndex> > weak = shape;
+        bool passed = registry.strict_union({shape}) == shape;
+        auto extension = registry.extension(shape);
+        std::size_t size = registry.size();
+        shape.reset();
+        extension.reset();
+        passed &= weak.expired() && registry.size() == size - 2;
+
+        auto other = enumerator.enumerate(HyperbolicCutShape<D>(23));
+        auto interned = registry.intern(other);
+        passed &= interned != other && *interned == *other && registry.intern(other) == interned;
+
+        std::cout << "release: " << (passed ? "ok" : "FAILED") << std::endl;
+        ok &= passed;
+    }
+
+    // concurrent interning hands out one instance
+    {
+        std::vector< ShapeEnumSharedPtr<D,MultiIndex> > shapes(16), interned(16), extensions(16);
+        for (auto& shape : shapes)
+            shape = enumerator.enumerate(HyperbolicCutShape<D>(31));
+
+        #pragma omp parallel for
+        for (int i = 0; i < 16; i++) {
+            interned[i] = registry.intern(shapes[i]);
+            extensions[i] = registry.extension(shapes[i]);
+        }
+
+        bool passed = true;
+        for (int i = 0; i < 16; i++)
+            passed &= interned[i] == interned[0] && extensions[i] == extensions[0];
+
+        std::cout << "concurrent: " << (passed ? "ok" : "FAILED") << std::endl;
+        ok &= passed;
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
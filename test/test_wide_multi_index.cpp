@@ -0,0 +1,212 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/hawp_commons.hpp"
+#include "waveblocks/wavepackets/shapes/tiny_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/wide_multi_index.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enumerator.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum_extended.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum_subset.hpp"
+#include "waveblocks/wavepackets/shapes/shape_hypercubic.hpp"
+#include "waveblocks/wavepackets/shapes/shape_hyperbolic.hpp"
+
+
+using namespace waveblocks;
+using namespace waveblocks::wavepackets;
+using namespace waveblocks::wavepackets::shapes;
+
+/**
+ * Compares less, equality and hashing against std::array for random pairs with long common prefixes.
+ */
+template<class UINT, dim_t D>
+bool check_operators(std::mt19937& rng)
+{
+    typedef WideMultiIndex<UINT,D> MultiIndex;
+
+    std::uniform_int_distribution<int> small(0, 2);
+    std::uniform_int_distribution<int> large(0, std::numeric_limits<UINT>::max());
+    std::uniform_int_distribution<int> axis(0, D-1);
+
+    bool ok = true;
+    for (int i = 0; i < 100000; i++) {
+        std::array<int,D> a, b;
+        for (dim_t d = 0; d < D; d++)
+            a[d] = b[d] = small(rng);
+        b[axis(rng)] = small(rng);
+        a[axis(rng)] = large(rng);
+
+        MultiIndex x(a), y(b);
+
+        ok &= std::less<MultiIndex>()(x, y) == std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+        ok &= std::less<MultiIndex>()(y, x) == std::lexicographical_compare(b.begin(), b.end(), a.begin(), a.end());
+        ok &= (x == y) == (a == b) && (x != y) == (a != b) && std::equal_to<MultiIndex>()(x, y) == (a == b);
+        ok &= (a != b) || std::hash<MultiIndex>()(x) == std::hash<MultiIndex>()(y);
+        ok &= std::array<int,D>(x) == a;
+    }
+
+    MultiIndex z;
+    z[D-1] = std::numeric_limits<UINT>::max();
+    z[D-1] -= 1;
+    ok &= z[D-1] == std::numeric_limits<UINT>::max() - 1;
+
+    std::cout << "operators: " << (8*sizeof(UINT)) << "-bit lanes, D = " << D
+              << ", " << sizeof(MultiIndex) << " bytes -> " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok;
+}
+
+/**
+ * Enumerates the same shape with both multi-index types and compares all nodes.
+ */
+template<dim_t D, class A, class B>
+bool same_nodes(ShapeEnum<D,A> const& a, ShapeEnum<D,B> const& b)
+{
+    bool ok = a.n_entries() == b.n_entries() && a.n_slices() == b.n_slices();
+    for (int islice = 0; ok && islice < a.n_slices(); islice++) {
+        ok &= a.slice(islice).size() == b.slice(islice).size();
+        for (std::size_t j = 0; ok && j < a.slice(islice).size(); j++)
+            ok &= std::array<int,D>(a.slice(islice)[j]) == std::array<int,D>(b.slice(islice)[j]);
+    }
+    return ok;
+}
+
+template<class Duration>
+double seconds(Duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+int main()
+{
+    bool ok = true;
+    std::mt19937 rng(7);
+
+    ok &= check_operators<std::uint8_t,3>(rng);
+    ok &= check_operators<std::uint8_t,10>(rng);
+    ok &= check_operators<std::uint8_t,20>(rng);
+    ok &= check_operators<std::uint16_t,10>(rng);
+    ok &= check_operators<std::uint16_t,17>(rng);
+
+    // required by io::write_shape_enum() and io::map_shape_enum()
+    ok &= std::is_trivially_copyable< WideMultiIndex<std::uint8_t,10> >::value;
+
+    // same enumeration, extension and lookups as TinyMultiIndex where both fit
+    {
+        const dim_t D = 10;
+        typedef TinyMultiIndex<std::size_t,D> Tiny;
+        typedef WideMultiIndex<std::uint8_t,D> Wide;
+
+        HyperbolicCutShape<D> shape(40);
+        auto tiny = ShapeEnumerator<D,Tiny>().generate(shape);
+        auto wide = ShapeEnumerator<D,Wide>().generate(shape);
+
+        bool same = same_nodes(tiny, wide);
+        same &= same_nodes(shape_enum::extend(&tiny), shape_enum::extend(&wide));
+
+        auto extended = shape_enum::extend(&wide);
+        wide.enable_hash_index();
+        auto map = shape_enum::subset_map(&extended, &wide);
+        for (std::size_t i = 0; i < wide.n_entries(); i++) {
+            std::size_t j = map.size();
+            for (int islice = 0; islice < extended.n_slices(); islice++) {
+                std::size_t ordinal;
+                auto const& slice = wide.slice(islice);
+                for (std::size_t k = 0; k < slice.size(); k++) {
+                    if (slice.offset() + k == i && extended.slice(islice).try_find(slice[k], ordinal))
+                        j = extended.slice(islice).offset() + ordinal;
+                }
+            }
+            same &= j < map.size() && map[j] == i;
+        }
+
+        std::cout << "hyperbolic cut D = 10, S = 40: |K| = " << wide.n_entries() << " -> " << (same ? "ok" : "FAILED") << std::endl;
+        ok &= same;
+    }
+
+    // shapes beyond TinyMultiIndex
+    {
+        const dim_t D = 10;
+        HyperbolicCutShape<D> shape(100);
+
+        // largest entry 99 does not fit into 6 bits
+        bool overflow = (1 << TinyMultiIndex<std::size_t,D>::BITS_PER_ENTRY) - 1 < shape.bbox(0);
+
+        auto wide8 = ShapeEnumerator<D,WideMultiIndex<std::uint8_t,D>>().generate(shape);
+        auto wide16 = ShapeEnumerator<D,WideMultiIndex<std::uint16_t,D>>().generate(shape);
+
+        bool same = overflow && same_nodes(wide8, wide16) && wide8.limit(0) == 99;
+
+        std::cout << "hyperbolic cut D = 10, S = 100: TinyMultiIndex overflows, |K| = " << wide8.n_entries()
+                  << " -> " << (same ? "ok" : "FAILED") << std::endl;
+        ok &= same;
+
+        bool thrown = false;
+        try {
+            ShapeEnumerator<D,WideMultiIndex<std::uint8_t,D>>().generate(HyperCubicShape<D>(300));
+        } catch (std::runtime_error const&) {
+            thrown = true;
+        }
+        ok &= thrown;
+    }
+
+    // evaluation agrees with TinyMultiIndex
+    {
+        const dim_t D = 3;
+        ScalarHaWp<D,TinyMultiIndex<std::size_t,D>> tiny;
+        ScalarHaWp<D,WideMultiIndex<std::uint8_t,D>> wide;
+
+        tiny.eps() = wide.eps() = 0.2;
+        tiny.shape() = ShapeEnumerator<D,TinyMultiIndex<std::size_t,D>>().enumerate(LimitedHyperbolicCutShape<D>(12, {6,5,4}));
+        wide.shape() = ShapeEnumerator<D,WideMultiIndex<std::uint8_t,D>>().enumerate(LimitedHyperbolicCutShape<D>(12, {6,5,4}));
+        tiny.coefficients() = Coefficients::Random(tiny.shape()->n_entries());
+        wide.coefficients() = tiny.coefficients();
+
+        RMatrix<D,Eigen::Dynamic> grid = RMatrix<D,Eigen::Dynamic>::Random(D,40);
+        real_t dev = (tiny.evaluate(grid) - wide.evaluate(grid)).abs().maxCoeff();
+
+        std::cout << "evaluate: max deviation " << dev << std::endl;
+        ok &= dev == 0;
+    }
+
+    // sorting: D = 10, entries below 64
+    {
+        const dim_t D = 10;
+        typedef TinyMultiIndex<std::size_t,D> Tiny;
+        typedef WideMultiIndex<std::uint8_t,D> Wide;
+
+        std::uniform_int_distribution<int> entry(0, 3);
+        std::vector<Tiny> tiny(1000000);
+        std::vector<Wide> wide(tiny.size());
+        std::vector< std::array<int,D> > plain(tiny.size());
+        for (std::size_t i = 0; i < tiny.size(); i++) {
+            for (dim_t d = 0; d < D; d++)
+                plain[i][d] = entry(rng);
+            tiny[i] = plain[i];
+            wide[i] = plain[i];
+        }
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        std::sort(tiny.begin(), tiny.end(), std::less<Tiny>());
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::sort(wide.begin(), wide.end(), std::less<Wide>());
+        auto t2 = std::chrono::high_resolution_clock::now();
+        std::sort(plain.begin(), plain.end());
+        auto t3 = std::chrono::high_resolution_clock::now();
+
+        bool same = true;
+        for (std::size_t i = 0; i < tiny.size(); i++)
+            same &= std::array<int,D>(tiny[i]) == plain[i] && std::array<int,D>(wide[i]) == plain[i];
+        ok &= same;
+
+        std::cout << "sort " << tiny.size() << " nodes: TinyMultiIndex " << seconds(t1 - t0)
+                  << " s, WideMultiIndex " << seconds(t2 - t1) << " s, std::array " << seconds(t3 - t2) << " s"
+                  << (same ? "" : " (MISMATCH)") << std::endl;
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
@@ -17,6 +18,7 @@
 namespace waveblocks {
     namespace innerproducts {
         using wavepackets::AbstractScalarHaWp;
+        using wavepackets::AbstractScalarHaWpBasis;
 
         /**
          * \brief Class providing homogeneous inner product calculation of scalar
@@ -25,8 +27,10 @@ namespace waveblocks {
          * \tparam D dimensionality of processed wavepackets
          * \tparam MultiIndex multi-index type of processed wavepackets
          * \tparam QR quadrature rule to use, with R nodes
+         * \tparam T real scalar type of the basis values, e.g. float for early, low-accuracy stages
+         * \tparam A real scalar type of the matrix products (accumulation), e.g. double with float basis values
          */
-        template<dim_t D, class MultiIndex, class QR>
+        template<dim_t D, class MultiIndex, class QR, class T = real_t, class A = T>
         class HomogeneousInnerProduct
         {
         public:
@@ -38,6 +42,8 @@ namespace waveblocks {
             using CMatrixDX = CMatrix<D, Eigen::Dynamic>;
             using RMatrixD1 = RMatrix<D, 1>;
             using CDiagonalXX = Eigen::DiagonalMatrix<complex_t, Eigen::Dynamic>;
+            using AMatrixXX = Eigen::Matrix<std::complex<A>, Eigen::Dynamic, Eigen::Dynamic>;
+            using ADiagonalXX = Eigen::DiagonalMatrix<std::complex<A>, Eigen::Dynamic>;
             using NodeMatrix = typename QR::NodeMatrix;
             using WeightVector = typename QR::WeightVector;
             using op_t = std::function<CMatrix1X(CMatrixDX,RMatrixD1)>;
@@ -54,9 +60,16 @@ namespace waveblocks {
              *   \mathbb{R}^D \rightarrow \mathbb{C}^R\f$ which is evaluated at the
              *   nodal points \f$x\f$ and position \f$q\f$;
              *   default returns a vector of ones
+             *
+             * \tparam K number of basis functions if known at compile-time (see wavepackets::StaticScalarHaWp),
+             *   the basis values and the result are fixed-size along this dimension
              */
-            static CMatrixXX build_matrix(const AbstractScalarHaWp<D, MultiIndex>& packet,
-                                          const op_t& op=default_op) {
+            template<int K = Eigen::Dynamic>
+            static CMatrix<K,K> build_matrix(const AbstractScalarHaWpBasis<D, MultiIndex>& packet,
+                                             const op_t& op=default_op) {
+                if (K != Eigen::Dynamic && packet.shape()->n_entries() != std::size_t(K))
+                    throw std::runtime_error("shape.size() != K");
+
                 const dim_t n_nodes = QR::number_nodes();
                 const CMatrixD1& q = packet.parameters().q().template cast<complex_t>();
                 const CMatrixDD& Q = packet.parameters().Q();
@@ -79,11 +92,11 @@ namespace waveblocks {
                     std::pow(packet.eps(), D) * weights.array() * values.array();
 
                 // Evaluate basis
-                const CMatrixXX basis = packet.evaluate_basis(transformed_nodes);
+                const Eigen::Matrix<std::complex<A>, K, Eigen::Dynamic> basis = packet.template evaluate_basis_as<T>(transformed_nodes).matrix().template cast<std::complex<A>>();
 
                 // Build matrix
-                const CDiagonalXX Dfactor(factor);
-                const CMatrixXX result = basis.matrix().conjugate() * Dfactor * basis.matrix().transpose();
+                const ADiagonalXX Dfactor(factor.template cast<std::complex<A>>());
+                const CMatrix<K,K> result = (basis.conjugate() * Dfactor * basis.transpose()).template cast<complex_t>();
 
                 // Global phase cancels out
                 return result;
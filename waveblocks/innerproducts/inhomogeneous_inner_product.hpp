@@ -25,8 +25,10 @@ namespace waveblocks {
          * \tparam D dimensionality of processed wavepackets
          * \tparam MultiIndex multi-index type of processed wavepackets
          * \tparam QR quadrature rule to use, with R nodes
+         * \tparam T real scalar type of the basis values, e.g. float for early, low-accuracy stages
+         * \tparam A real scalar type of the matrix products (accumulation), e.g. double with float basis values
          */
-        template<dim_t D, class MultiIndex, class QR>
+        template<dim_t D, class MultiIndex, class QR, class T = real_t, class A = T>
         class InhomogeneousInnerProduct
         {
         public:
@@ -39,6 +41,8 @@ namespace waveblocks {
             using RMatrixDD = RMatrix<D, D>;
             using RMatrixD1 = RMatrix<D, 1>;
             using CDiagonalXX = Eigen::DiagonalMatrix<complex_t, Eigen::Dynamic>;
+            using AMatrixXX = Eigen::Matrix<std::complex<A>, Eigen::Dynamic, Eigen::Dynamic>;
+            using ADiagonalXX = Eigen::DiagonalMatrix<std::complex<A>, Eigen::Dynamic>;
             using NodeMatrix = typename QR::NodeMatrix;
             using WeightVector = typename QR::WeightVector;
             using op_t = std::function<CMatrix1X(CMatrixDX,RMatrixD1)>;
@@ -84,12 +88,12 @@ namespace waveblocks {
                     std::pow(packet.eps(), D) * weights.array() * values.array();
 
                 // Evaluate basis
-                const CMatrixXX basisr = pacbra.evaluate_basis(transformed_nodes);
-                const CMatrixXX basisc = packet.evaluate_basis(transformed_nodes);
+                const AMatrixXX basisr = pacbra.template evaluate_basis_as<T>(transformed_nodes).matrix().template cast<std::complex<A>>();
+                const AMatrixXX basisc = packet.template evaluate_basis_as<T>(transformed_nodes).matrix().template cast<std::complex<A>>();
 
                 // Build matrix
-                const CDiagonalXX Dfactor(factor);
-                const CMatrixXX result = basisr.matrix().conjugate() * Dfactor * basisc.matrix().transpose();
+                const ADiagonalXX Dfactor(factor.template cast<std::complex<A>>());
+                const CMatrixXX result = (basisr.conjugate() * Dfactor * basisc.transpose()).template cast<complex_t>();
 
                 // Global phase
                 const complex_t phase = std::exp(complex_t(0,1) * (S_ket - std::conj(S_bra)) / std::pow(packet.eps(),2));
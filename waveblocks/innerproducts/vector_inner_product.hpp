@@ -24,8 +24,10 @@ namespace waveblocks {
          * \tparam D dimensionality of processed wavepackets
          * \tparam MultiIndex multi-index type of processed wavepackets
          * \tparam QR quadrature rule to use, with R nodes
+         * \tparam T real scalar type of the basis values, e.g. float for early, low-accuracy stages
+         * \tparam A real scalar type of the matrix products (accumulation), e.g. double with float basis values
          */
-        template<dim_t D, class MultiIndex, class QR>
+        template<dim_t D, class MultiIndex, class QR, class T = real_t, class A = T>
         class VectorInnerProduct
         {
         public:
@@ -81,7 +83,7 @@ namespace waveblocks {
                 CMatrixNN result(total_size, total_size);
 
                 // Calculate matrix.
-                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR>;
+                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR,T,A>;
                 for (dim_t i = 0; i < n_components; ++i) {
                     for (dim_t j = 0; j < n_components; ++j) {
                         using namespace std::placeholders;
@@ -148,7 +150,7 @@ namespace waveblocks {
                 CMatrixNN result(total_rows, total_cols);
 
                 // Calculate matrix.
-                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR>;
+                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR,T,A>;
                 for (dim_t i = 0; i < n_components_bra; ++i) {
                     for (dim_t j = 0; j < n_components_ket; ++j) {
                         using namespace std::placeholders;
@@ -176,7 +178,7 @@ namespace waveblocks {
                 CMatrixN1 result(n_components * n_components, 1);
 
                 // Calculate matrix.
-                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR>;
+                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR,T,A>;
                 for (dim_t i = 0; i < n_components; ++i) {
                     for (dim_t j = 0; j < n_components; ++j) {
                         using namespace std::placeholders;
@@ -204,7 +206,7 @@ namespace waveblocks {
                 CMatrixN1 result(n_components_bra * n_components_ket, 1);
 
                 // Calculate matrix.
-                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR>;
+                using IP = InhomogeneousInnerProduct<D,MultiIndex,QR,T,A>;
                 for (dim_t i = 0; i < n_components_bra; ++i) {
                     for (dim_t j = 0; j < n_components_ket; ++j) {
                         using namespace std::placeholders;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <stdexcept>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+
+
+namespace waveblocks
+{
+    namespace io
+    {
+    /**
+     * \brief Writes streamed grid values into a raw binary file.
+     *
+     * The file holds one complex number per grid point (real and imaginary part as native doubles)
+     * in the order of the grid points, thus it can be memory-mapped afterwards,
+     * e.g. with <tt>numpy.memmap(name, dtype=complex128, shape=extents)</tt>.
+     * Only the current block is kept in memory.
+     *
+     * Use it as sink of wavepackets::HaWpStreamEvaluator.
+     */
+    class BinaryGridSink
+    {
+    public:
+        /**
+         * \param name Name of the file, an existing file is truncated.
+         */
+        explicit BinaryGridSink(std::string const& name)
+            : file_(name, std::ios::out | std::ios::binary | std::ios::trunc)
+        {
+            if (!file_)
+                throw std::runtime_error("BinaryGridSink: cannot open " + name);
+        }
+
+        /**
+         * \brief Writes the values of the grid points [first, first + values.size()).
+         */
+        void operator()(long first, CArray<1,Eigen::Dynamic> const& values)
+        {
+            file_.seekp(first*sizeof(complex_t));
+            file_.write(reinterpret_cast<char const*>(values.data()), values.size()*sizeof(complex_t));
+
+            if (!file_)
+                throw std::runtime_error("BinaryGridSink: write failed");
+        }
+
+    private:
+        std::ofstream file_;
+    };
+    }
+}
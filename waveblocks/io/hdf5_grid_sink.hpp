@@ -0,0 +1,100 @@
+#pragma once
+
+//need H5 Cpp header for HDF interface
+#include "H5Cpp.h"
+
+#include <array>
+#include <string>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include "waveblocks/types.hpp"
+
+
+namespace waveblocks
+{
+    namespace io
+    {
+    /**
+     * \brief Writes streamed grid values into an HDF5 dataset.
+     *
+     * The dataset has shape \f$ n_0 \times \dots \times n_{D-1} \f$ (the extents of the grid)
+     * and stores complex numbers as compound type with members "r" and "i" (same as hdf5writer),
+     * thus it is compatible with the python interface.
+     * Each block is written directly into the dataset, only the current block is kept in memory.
+     *
+     * Use it as sink of wavepackets::HaWpStreamEvaluator. The grid points must be numbered
+     * in row-major order (the last axis varies fastest), as in wavepackets::RegularGrid.
+     *
+     * \tparam D dimensionality of the grid
+     */
+    template<int D>
+    class HDF5GridSink
+    {
+    public:
+        /**
+         * \param name Name of the file, an existing file is truncated.
+         * \param dataset Name of the dataset within the file.
+         * \param extents Number of grid points along each axis.
+         */
+        HDF5GridSink(std::string const& name, std::string const& dataset, std::array<long, std::size_t(D)> const& extents)
+            : ctype_(sizeof(complex_t))
+            , file_(name, H5F_ACC_TRUNC)
+        {
+            // std::complex<double> is layout-compatible with {double r; double i;}
+            ctype_.insertMember("r", 0, H5::PredType::NATIVE_DOUBLE);
+            ctype_.insertMember("i", sizeof(real_t), H5::PredType::NATIVE_DOUBLE);
+
+            for (int d = 0; d < D; d++)
+                extents_[d] = extents[d];
+
+            filespace_ = H5::DataSpace(D, extents_.data());
+            dataset_ = file_.createDataSet(dataset, ctype_, filespace_);
+        }
+
+        /**
+         * \brief Writes the values of the grid points [first, first + values.size()).
+         *
+         * A contiguous range of grid points consists of pieces of rows along the last axis.
+         * The union of these pieces is selected and written at once.
+         */
+        void operator()(long first, CArray<1,Eigen::Dynamic> const& values)
+        {
+            const hsize_t end = first + values.size();
+
+            filespace_.selectNone();
+
+            for (hsize_t pos = first; pos < end; ) {
+                // multi-index of pos
+                std::array<hsize_t, std::size_t(D)> start;
+                hsize_t rest = pos;
+                for (int d = D-1; d >= 0; d--) {
+                    start[d] = rest % extents_[d];
+                    rest /= extents_[d];
+                }
+
+                std::array<hsize_t, std::size_t(D)> count;
+                count.fill(1);
+                count[D-1] = std::min<hsize_t>(end - pos, extents_[D-1] - start[D-1]);
+
+                filespace_.selectHyperslab(H5S_SELECT_OR, count.data(), start.data());
+
+                pos += count[D-1];
+            }
+
+            hsize_t n = values.size();
+            H5::DataSpace memspace(1, &n);
+
+            dataset_.write(values.data(), ctype_, memspace, filespace_);
+        }
+
+    private:
+        std::array<hsize_t, std::size_t(D)> extents_;
+        H5::CompType ctype_;
+        H5::H5File file_;
+        H5::DataSpace filespace_;
+        H5::DataSet dataset_;
+    };
+    }
+}
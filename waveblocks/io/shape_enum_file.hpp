@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "waveblocks/types.hpp"
+#include "waveblocks/wavepackets/shapes/shape_enum.hpp"
+
+
+namespace waveblocks
+{
+    namespace io
+    {
+    /**
+     * \brief Fixed-size header of a shape enumeration file (see write_shape_enum()).
+     *
+     * The header is followed by these sections, each starting at a multiple of 64 bytes:
+     *  1. description: \p description_size characters
+     *  2. limits: \f$ D \f$ int32
+     *  3. limits: one MultiIndex (checks that both programs pack multi-indices alike)
+     *  4. slice offsets: \p n_slices + 1 uint64
+     *  5. nodes: \p n_entries MultiIndex, slice by slice
+     *  6. optional (flag 1) neighbour links (see ShapeSliceLinks) of all slices, concatenated:
+     *     \f$ D \cdot \f$ \p n_entries uint32 backward, \f$ D \cdot \f$ \p n_entries double sqrt, \p n_entries int32 axis
+     *
+     * All numbers use the native byte order.
+     */
+    struct ShapeEnumFileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t dimensionality;
+        std::uint32_t index_size;
+        std::uint32_t n_slices;
+        std::uint64_t n_entries;
+        std::uint64_t flags;
+        std::uint64_t description_size;
+    };
+
+    namespace shape_enum_file_detail
+    {
+        static const char magic[8] = {'W','B','S','H','A','P','E','\0'};
+        static const std::uint32_t version = 1;
+        static const std::uint64_t flag_links = 1;
+
+        inline std::size_t align(std::size_t pos)
+        {
+            return (pos + 63) & ~std::size_t(63);
+        }
+
+        /**
+         * \brief Positions of all sections within a file.
+         */
+        template<dim_t D, class MultiIndex>
+        struct Layout
+        {
+            std::size_t description, int_limits, index_limits, offsets, nodes, backward, sqrt, axis, end;
+
+            explicit Layout(ShapeEnumFileHeader const& header)
+            {
+                description = align(sizeof(ShapeEnumFileHeader));
+                int_limits = align(description + header.description_size);
+                index_limits = align(int_limits + D*sizeof(std::int32_t));
+                offsets = align(index_limits + sizeof(MultiIndex));
+                nodes = align(offsets + (header.n_slices + 1)*sizeof(std::uint64_t));
+                end = nodes + header.n_entries*sizeof(MultiIndex);
+
+                if (header.flags & flag_links) {
+                    backward = align(end);
+                    sqrt = align(backward + header.n_entries*D*sizeof(std::uint32_t));
+                    axis = align(sqrt + header.n_entries*D*sizeof(double));
+                    end = axis + header.n_entries*sizeof(std::int32_t);
+                }
+                else {
+                    backward = sqrt = axis = end;
+                }
+            }
+        };
+
+        /**
+         * \brief Checks that stored neighbour links stay within the previous slice.
+         *
+         * Every backward entry must be npos or an ordinal within the previous slice,
+         * every recursion axis must be in \f$ [0,D) \f$ and point to an existing neighbour,
+         * except for the node \f$ \underline{0} \f$ in slice 0, whose axis is \f$ D \f$.
+         */
+        template<dim_t D>
+        bool valid_links(std::uint64_t const* offsets, std::uint32_t n_slices,
+                         std::uint32_t const* backward, std::int32_t const* axis)
+        {
+            typedef wavepackets::shapes::ShapeSliceLinks<D> Links;
+
+            std::uint64_t prev_size = 0;
+            for (std::uint32_t islice = 0; islice < n_slices; islice++) {
+                for (std::uint64_t j = offsets[islice]; j < offsets[islice+1]; j++) {
+                    if (islice == 0 ? axis[j] != D : (axis[j] < 0 || axis[j] >= D || backward[j*D + axis[j]] == Links::npos))
+                        return false;
+
+                    for (dim_t d = 0; d < D; d++) {
+                        if (backward[j*D + d] != Links::npos && backward[j*D + d] >= prev_size)
+                            return false;
+                    }
+                }
+                prev_size = offsets[islice+1] - offsets[islice];
+            }
+
+            return true;
+        }
+
+        inline void write_at(std::ofstream& file, std::size_t pos, void const* data, std::size_t size)
+        {
+            file.seekp(pos);
+            file.write(reinterpret_cast<char const*>(data), size);
+        }
+    }
+
+    /**
+     * \brief Writes a shape enumeration into a binary file that can be memory-mapped by map_shape_enum().
+     *
+     * \param shape The enumeration.
+     * \param name Name of the file, an existing file is truncated.
+     * \param description Arbitrary text to recognize the file later, e.g. the identity key of the shape (see AbstractShape::identity()).
+     * \param with_links Whether to store the neighbour links (see ShapeEnum::links()), which are built if necessary.
+     */
+    template<dim_t D, class MultiIndex>
+    void write_shape_enum(wavepackets::shapes::ShapeEnum<D,MultiIndex> const& shape,
+                          std::string const& name,
+                          std::string const& description = "",
+                          bool with_links = true)
+    {
+        static_assert(std::is_trivially_copyable<MultiIndex>::value, "multi-index type must be trivially copyable");
+
+        namespace detail = shape_enum_file_detail;
+
+        ShapeEnumFileHeader header;
+        std::memcpy(header.magic, detail::magic, sizeof(header.magic));
+        header.version = detail::version;
+        header.dimensionality = D;
+        header.index_size = sizeof(MultiIndex);
+        header.n_slices = shape.n_slices();
+        header.n_entries = shape.n_entries();
+        header.flags = with_links ? detail::flag_links : 0;
+        header.description_size = description.size();
+
+        detail::Layout<D,MultiIndex> layout(header);
+
+        std::ofstream file(name, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("write_shape_enum: cannot open " + name);
+
+        detail::write_at(file, 0, &header, sizeof(header));
+        detail::write_at(file, layout.description, description.data(), description.size());
+
+        std::int32_t int_limits[D];
+        for (dim_t d = 0; d < D; d++)
+            int_limits[d] = shape.limit(d);
+        detail::write_at(file, layout.int_limits, int_limits, sizeof(int_limits));
+
+        MultiIndex index_limits = shape.limits();
+        detail::write_at(file, layout.index_limits, &index_limits, sizeof(index_limits));
+
+        std::vector<std::uint64_t> offsets(header.n_slices + 1);
+        for (int islice = 0; islice <= shape.n_slices(); islice++)
+            offsets[islice] = shape.slice(islice).offset();
+        detail::write_at(file, layout.offsets, offsets.data(), offsets.size()*sizeof(std::uint64_t));
+
+        for (int islice = 0; islice < shape.n_slices(); islice++) {
+            auto const& slice = shape.slice(islice);
+            detail::write_at(file, layout.nodes + slice.offset()*sizeof(MultiIndex), slice.begin(), slice.size()*sizeof(MultiIndex));
+        }
+
+        if (with_links) {
+            for (int islice = 0; islice < shape.n_slices(); islice++) {
+                auto const& links = shape.links(islice);
+                std::size_t offset = shape.slice(islice).offset();
+
+                std::vector<std::int32_t> axis(links.axis.begin(), links.axis.end());
+
+                detail::write_at(file, layout.backward + offset*D*sizeof(std::uint32_t), links.backward.data(), links.backward.size()*sizeof(std::uint32_t));
+                detail::write_at(file, layout.sqrt + offset*D*sizeof(double), links.sqrt.data(), links.sqrt.size()*sizeof(double));
+                detail::write_at(file, layout.axis + offset*sizeof(std::int32_t), axis.data(), axis.size()*sizeof(std::int32_t));
+            }
+        }
+
+        // extend the file to its full size, even if the last section is empty
+        if (layout.end > 0) {
+            char zero = 0;
+            file.seekp(layout.end - 1);
+            file.write(&zero, 1);
+        }
+
+        if (!file)
+            throw std::runtime_error("write_shape_enum: write failed");
+    }
+
+    /**
+     * \brief Maps a file written by write_shape_enum() read-only into memory.
+     *
+     * The slices of the returned enumeration refer to the mapped nodes without copying them
+     * (see wavepackets::shapes::ShapeSlice::mapped()). The mapping is released when the
+     * enumeration and all copies of its slices are destroyed.
+     * Stored neighbour links are installed as well (copied into ShapeSliceLinks),
+     * such that neither enumeration nor neighbour search is needed.
+     *
+     * \param name Name of the file.
+     * \param description If not null, the file must have been written with this description.
+     * \return The enumeration or null, if the file does not exist, is not a valid shape file
+     * for this dimensionality and multi-index type (including links out of bounds) or has another description.
+     */
+    template<dim_t D, class MultiIndex>
+    std::shared_ptr< wavepackets::shapes::ShapeEnum<D,MultiIndex> > map_shape_enum(std::string const& name,
+                                                                                   std::string const* description = nullptr)
+    {
+        static_assert(std::is_trivially_copyable<MultiIndex>::value, "multi-index type must be trivially copyable");
+
+        namespace detail = shape_enum_file_detail;
+        using namespace wavepackets::shapes;
+
+        int fd = ::open(name.c_str(), O_RDONLY);
+        if (fd < 0)
+            return nullptr;
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || std::size_t(info.st_size) < sizeof(ShapeEnumFileHeader)) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        const std::size_t size = info.st_size;
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (addr == MAP_FAILED)
+            return nullptr;
+
+        std::shared_ptr<const void> storage(addr, [size](const void* p) { ::munmap(const_cast<void*>(p), size); });
+        const char* base = static_cast<const char*>(addr);
+
+        ShapeEnumFileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+
+        if (std::memcmp(header.magic, detail::magic, sizeof(header.magic)) != 0 ||
+            header.version != detail::version ||
+            header.dimensionality != std::uint32_t(D) ||
+            header.index_size != sizeof(MultiIndex))
+            return nullptr;
+
+        detail::Layout<D,MultiIndex> layout(header);
+        if (layout.end > size)
+            return nullptr;
+
+        if (description && description->compare(0, std::string::npos, base + layout.description, header.description_size) != 0)
+            return nullptr;
+
+        const std::int32_t* int_limits = reinterpret_cast<const std::int32_t*>(base + layout.int_limits);
+        MultiIndex limits;
+        std::memcpy(&limits, base + layout.index_limits, sizeof(limits));
+        for (dim_t d = 0; d < D; d++) {
+            if ((std::int32_t)limits[d] != int_limits[d])
+                return nullptr;
+        }
+
+        const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(base + layout.offsets);
+        if (offsets[0] != 0 || offsets[header.n_slices] != header.n_entries)
+            return nullptr;
+
+        const MultiIndex* nodes = reinterpret_cast<const MultiIndex*>(base + layout.nodes);
+
+        std::vector< ShapeSlice<D,MultiIndex> > slices;
+        slices.reserve(header.n_slices);
+        for (std::uint32_t islice = 0; islice < header.n_slices; islice++) {
+            if (offsets[islice] > offsets[islice+1])
+                return nullptr;
+
+            slices.emplace_back(storage, nodes + offsets[islice], offsets[islice+1] - offsets[islice], offsets[islice]);
+        }
+
+        auto shape = std::make_shared< ShapeEnum<D,MultiIndex> >(std::move(slices), header.n_entries, limits);
+        shape->set_indexer();
+
+        if (header.flags & detail::flag_links) {
+            const std::uint32_t* backward = reinterpret_cast<const std::uint32_t*>(base + layout.backward);
+            const double* sqrt = reinterpret_cast<const double*>(base + layout.sqrt);
+            const std::int32_t* axis = reinterpret_cast<const std::int32_t*>(base + layout.axis);
+
+            if (!detail::valid_links<D>(offsets, header.n_slices, backward, axis))
+                return nullptr;
+
+            auto table = std::make_shared< std::vector< ShapeSliceLinks<D> > >(header.n_slices);
+            for (std::uint32_t islice = 0; islice < header.n_slices; islice++) {
+                std::size_t first = offsets[islice], last = offsets[islice+1];
+                ShapeSliceLinks<D>& links = (*table)[islice];
+                links.backward.assign(backward + first*D, backward + last*D);
+                links.sqrt.assign(sqrt + first*D, sqrt + last*D);
+                links.axis.assign(axis + first, axis + last);
+            }
+
+            shape->set_links(std::move(table));
+        }
+
+        return shape;
+    }
+    }
+}
@@ -55,6 +55,8 @@ namespace waveblocks {
             KahanSum(const T &zero)
                 : sum_(zero)
                 , c_(zero)
+                , y_(zero)
+                , t_(zero)
             { }
 
             /**
@@ -81,6 +83,25 @@ namespace waveblocks {
                 return *this;
             }
 
+            /**
+             * \brief adds a number given as an expression
+             *
+             * Expression types (e.g. Eigen expression templates) are evaluated
+             * directly into the preallocated temporaries, thus no temporary
+             * summand of type \p T is created.
+             *
+             * \param[in] summand summand
+             */
+            template<class E>
+            KahanSum &operator+=(const E &summand)
+            {
+                y_ = summand - c_;
+                t_ = sum_ + y_;
+                c_ = (t_ - sum_) - y_;
+                sum_ = t_;
+                return *this;
+            }
+
             /**
              * \brief retrieves accumulated sum.
              *
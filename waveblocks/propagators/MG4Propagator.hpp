@@ -27,7 +27,7 @@ class MG4Propagator : public Propagator<MG4Propagator<N,D,MultiIndex_t,MDQR_t,Po
 		void propagate(const real_t Dt) {
 
 			auto& packet = this->wpacket_;
-			CMatrix<Eigen::Dynamic,Eigen::Dynamic> A1, A2;
+			typename MG4Propagator::FMatrix_t A1, A2;
 			// Gauss Legendre coefficients on [0,Dt]:
 			real_t h1 = (3.-std::sqrt(3.))/6. * Dt;
 			real_t h2 = 2.*std::sqrt(3.)/6. * Dt;
@@ -41,7 +41,7 @@ class MG4Propagator : public Propagator<MG4Propagator<N,D,MultiIndex_t,MDQR_t,Po
 			this->buildF(A2);
 			A2 *= complex_t(0,-1./(packet.eps()*packet.eps()));
 			this->F_ = .5*Dt*(A1+A2) + std::sqrt(3)/12*Dt*Dt*(A2*A1-A1*A2);
-			CVector<Eigen::Dynamic> coefs = utils::PacketToCoefficients<Packet_t>::to(packet); // get coefficients from packet
+			typename MG4Propagator::CoefVector_t coefs = utils::PacketToCoefficients<Packet_t>::to(packet); // get coefficients from packet
 			coefs = (this->F_).exp() * coefs;
 			utils::PacketToCoefficients<Packet_t>::from(coefs,packet); // update packet from coefficients
 			this->intSplit(h1,M1,this->splitCoef_);
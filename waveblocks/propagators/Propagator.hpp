@@ -26,6 +26,15 @@ namespace propagators {
 namespace print = utilities::prettyprint;
 namespace utils = utilities;
 
+/**
+ * \brief whether a wave packet type is single-level (ScalarHaWp or StaticScalarHaWp)
+ */
+template <typename Packet_t, int D, typename MultiIndex_t>
+struct IsScalarPacket : std::is_same<Packet_t,wavepackets::ScalarHaWp<D,MultiIndex_t>> {};
+
+template <int D, typename MultiIndex_t, int K>
+struct IsScalarPacket<wavepackets::StaticScalarHaWp<D,MultiIndex_t,K>,D,MultiIndex_t> : std::true_type {};
+
 /**
  * \brief generic abstract propagator class for Hagedorn Wave Packets
  *
@@ -41,14 +50,23 @@ class Propagator {
 	
 	protected:
 
+		/// number of coefficients if known at compile-time (StaticScalarHaWp), otherwise Eigen::Dynamic
+		static const int K_ = utils::PacketToCoefficients<Packet_t>::SizeAtCompileTime;
+
+		using CoefVector_t = CVector<K_>; ///< coefficients of all levels
+		using FMatrix_t = CMatrix<K_,K_>; ///< interaction matrix F, fixed-size for StaticScalarHaWp
+
 		Packet_t& wpacket_; ///< wave packet to be propagated
 		Potential_t& V_; ///< potential energy
 		Coef_t splitCoef_;
-		CMatrix<Eigen::Dynamic,Eigen::Dynamic> F_;
+		FMatrix_t F_;
+		std::function<void(Packet_t&)> afterStep_; ///< optional hook, called after each time step
 
 
 	public:
 
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 		/**
 		 * \brief Propagator constructor
 		 *
@@ -72,7 +90,7 @@ class Propagator {
 		 * \tparam U Dummy template parameter, neccessary for enable_if
 		 */
 		template <typename U=Packet_t>
-		typename std::enable_if<std::is_same<U,wavepackets::ScalarHaWp<D,MultiIndex_t>>::value,void>::type
+		typename std::enable_if<IsScalarPacket<U,D,MultiIndex_t>::value,void>::type
 		onConstruct() {
 			static_assert(N==1,"Scalar wave packets must have N==1");
 		}
@@ -89,7 +107,7 @@ class Propagator {
 		 * \tparam U Dummy template parameter, neccessary for enable_if
 		 */
 		template <typename U=Packet_t>
-		typename std::enable_if<!std::is_same<U,wavepackets::ScalarHaWp<D,MultiIndex_t>>::value,void>::type
+		typename std::enable_if<!IsScalarPacket<U,D,MultiIndex_t>::value,void>::type
 		onConstruct() {
 			static_assert(N>1,"Multi-Level wave packets must have N>1");
 			unsigned size = 0;
@@ -120,7 +138,7 @@ class Propagator {
 			unsigned M = std::round(T/Dt);
 
 			{
-				const bool scalar = std::is_same<Packet_t,wavepackets::ScalarHaWp<D,MultiIndex_t>>::value;
+				const bool scalar = IsScalarPacket<Packet_t,D,MultiIndex_t>::value;
 				const bool hom = std::is_same<Packet_t,wavepackets::InhomogeneousHaWp<D,MultiIndex_t>>::value;
 				std::cout << "\n\n";
 				print::title(getName() + " Propagator");
@@ -147,6 +165,7 @@ class Propagator {
 			for(unsigned m=1; m<=M; ++m) {
 				t += Dt;
 				propagate(Dt);
+				if(afterStep_) afterStep_(wpacket_);
 				callback(m,t);
 				print::pair("Time t",t,"\r");
 			}
@@ -162,6 +181,20 @@ class Propagator {
 
 		}
 
+		/**
+		 * \brief install a function that is called with the wave packet after each time step of evolve()
+		 *
+		 * The hook may change the basis shapes of the packet, e.g. wavepackets::HaWpShapeAdapter
+		 * prunes negligible and adds required basis functions. The next step with W builds F for the new shapes.
+		 * The hook runs once per completed time step (before the callback of evolve()), never within
+		 * a splitting sequence or the pre- and post-processing of processed methods (Pre764Propagator).
+		 *
+		 * \param hook Function taking the wave packet (Packet_t&), an empty function removes the hook
+		 */
+		inline void afterStep(const std::function<void(Packet_t&)> hook) {
+			afterStep_ = hook;
+		}
+
 
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -342,7 +375,7 @@ class Propagator {
 			*/
 
 			buildF();
-			CVector<Eigen::Dynamic> coefs = utils::PacketToCoefficients<Packet_t>::to(wpacket_); // get coefficients from packet
+			CoefVector_t coefs = utils::PacketToCoefficients<Packet_t>::to(wpacket_); // get coefficients from packet
 			complex_t factor(0,-h/(wpacket_.eps()*wpacket_.eps()));
 			coefs = (factor*F_).exp() * coefs; ///< c = exp(-i*h/eps^2 * F) * c
 			utils::PacketToCoefficients<Packet_t>::from(coefs,wpacket_); // update packet from coefficients
@@ -358,7 +391,7 @@ class Propagator {
 		 */
         template <int N_LEVELS=N>
         typename std::enable_if<(N_LEVELS>1),void>::type // N>1
-		buildF(CMatrix<Eigen::Dynamic,Eigen::Dynamic>& M) {
+		buildF(FMatrix_t& M) {
 
 			auto op = [&] (const CMatrix<D,Eigen::Dynamic>& x, const RMatrix<D,1>& q, const dim_t i, const dim_t j)
 				{
@@ -389,7 +422,7 @@ class Propagator {
 		 */
         template <int N_LEVELS=N>
         typename std::enable_if<(N_LEVELS==1),void>::type // N=1
-		buildF(CMatrix<Eigen::Dynamic,Eigen::Dynamic>& M) {
+		buildF(FMatrix_t& M) {
 
 			auto op = [&] (const CMatrix<D,Eigen::Dynamic>& x, const RMatrix<D,1>& q)
 				{
@@ -409,7 +442,7 @@ class Propagator {
 					return f;
 				};
 
-			M = innerproducts::HomogeneousInnerProduct<D,MultiIndex_t,MDQR_t>::build_matrix(wpacket_,op);
+			M = innerproducts::HomogeneousInnerProduct<D,MultiIndex_t,MDQR_t>::template build_matrix<K_>(wpacket_,op);
 		}
 
 
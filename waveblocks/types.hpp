@@ -27,8 +27,9 @@ namespace waveblocks
     template<int R, int C>
     using RArray = Eigen::Array<real_t,R,C>;
 
-    template<int N>
-    using HaWpBasisVector = CArray<Eigen::Dynamic, N>;
+    // basis values (rows) on quadrature points (columns), T = float for low-accuracy sampling
+    template<int N, class T = real_t>
+    using HaWpBasisVector = Eigen::Array<std::complex<T>, Eigen::Dynamic, N>;
 
     using Coefficients = Eigen::Matrix<complex_t, Eigen::Dynamic, 1>;
 
@@ -144,6 +144,9 @@ namespace waveblocks {
 
         template<class Packet>
         struct PacketToCoefficients {
+            /// number of coefficients if known at compile-time, otherwise Eigen::Dynamic
+            static const int SizeAtCompileTime = Eigen::Dynamic;
+
             static CVector<Eigen::Dynamic> to(const Packet& packet) {
 
                 // Compute size
@@ -190,6 +193,8 @@ namespace waveblocks {
 
         template<int D, class MultiIndex>
         struct PacketToCoefficients<wavepackets::ScalarHaWp<D,MultiIndex>> {
+            static const int SizeAtCompileTime = Eigen::Dynamic;
+
             static const CVector<Eigen::Dynamic>& to(const wavepackets::ScalarHaWp<D,MultiIndex>& packet) {
                 return packet.coefficients();
             }
@@ -199,5 +204,18 @@ namespace waveblocks {
             }
 
         };
+
+        template<int D, class MultiIndex, int K>
+        struct PacketToCoefficients<wavepackets::StaticScalarHaWp<D,MultiIndex,K>> {
+            static const int SizeAtCompileTime = K;
+
+            static const CVector<K>& to(const wavepackets::StaticScalarHaWp<D,MultiIndex,K>& packet) {
+                return packet.coefficients();
+            }
+
+            static void from(const CVector<K>& coefficients, wavepackets::StaticScalarHaWp<D,MultiIndex,K>& packet) {
+                packet.coefficients() = coefficients;
+            }
+        };
     }
 }
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+
+namespace waveblocks {
+    namespace utilities {
+        /**
+         * \brief Shared pointer that may be loaded and replaced by several threads at once.
+         *
+         * Stands in for C++20's <tt>std::atomic<std::shared_ptr<T>></tt> using the C++11
+         * atomic access functions for shared pointers. Copying takes a snapshot of the other pointer.
+         *
+         * Caches use it to publish immutable snapshots from const member functions:
+         * readers load a snapshot, check whether it is current and otherwise build and store a new one.
+         */
+        template<class T>
+        class AtomicSharedPtr
+        {
+        public:
+            AtomicSharedPtr() = default;
+
+            AtomicSharedPtr(std::shared_ptr<T> ptr)
+                : ptr_(std::move(ptr))
+            { }
+
+            AtomicSharedPtr(AtomicSharedPtr const& that)
+                : ptr_(that.load())
+            { }
+
+            AtomicSharedPtr &operator=(AtomicSharedPtr const& that)
+            {
+                store(that.load());
+                return *this;
+            }
+
+            std::shared_ptr<T> load() const
+            {
+                return std::atomic_load(&ptr_);
+            }
+
+            void store(std::shared_ptr<T> ptr)
+            {
+                std::atomic_store(&ptr_, std::move(ptr));
+            }
+
+        private:
+            std::shared_ptr<T> ptr_;
+        };
+
+        /**
+         * \brief Checks whether a weak pointer refers to the same object as a shared pointer.
+         *
+         * Unlike comparing addresses, an expired pointer never equals a new object at the same address.
+         */
+        template<class T, class U>
+        bool same_owner(std::weak_ptr<T> const& a, std::shared_ptr<U> const& b)
+        {
+            return !a.owner_before(b) && !b.owner_before(a);
+        }
+    }
+}
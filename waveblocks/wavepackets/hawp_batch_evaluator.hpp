@@ -0,0 +1,158 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "hawp_commons.hpp"
+
+
+namespace waveblocks {
+    namespace wavepackets {
+        /**
+         * \brief Evaluates many scalar wavepackets on one shared grid.
+         *
+         * Wavepackets that share \f$ \varepsilon \f$, the Hagedorn parameter set \f$ \Pi \f$
+         * and the basis shape (e.g. an ensemble that only differs in the coefficients)
+         * are grouped. Each group runs the recursion once and contracts the
+         * coefficients of all its members at once (see HaWpEvaluator::batch_reduce()).
+         * Wavepackets with different parameter sets form groups of their own.
+         *
+         * The groups are distributed among the OpenMP threads. Each thread evaluates
+         * its groups serially and reuses its slice buffers for all of them.
+         *
+         * \tparam D dimensionality of wavepackets
+         * \tparam MultiIndex The type used to represent multi-indices.
+         * \tparam N Number of quadrature points.
+         */
+        template<dim_t D, class MultiIndex, int N>
+        class HaWpBatchEvaluator
+        {
+        public:
+            typedef AbstractScalarHaWp<D,MultiIndex> Packet;
+
+            /**
+             * \param[in] grid Complex quadrature points of shape \f$ (D \times N) \f$.
+             */
+            explicit HaWpBatchEvaluator(CMatrix<D,N> const& grid)
+                : is_real_(false)
+                , grid_(grid)
+            { }
+
+            /**
+             * The evaluators keep \f$ x - q \f$ real (see HaWpEvaluator).
+             *
+             * \param[in] rgrid Real quadrature points of shape \f$ (D \times N) \f$.
+             */
+            explicit HaWpBatchEvaluator(RMatrix<D,N> const& rgrid)
+                : is_real_(true)
+                , rgrid_(rgrid)
+            { }
+
+            /**
+             * \brief Evaluates all wavepackets \f$ \Phi_i(x) \f$ on the grid.
+             *
+             * Notice that this function does not include the prefactor
+             * \f$ \frac{1}{\sqrt{det(Q)}} \f$ nor the global phase
+             * \f$ \exp{(\frac{iS}{\varepsilon^2})} \f$ (same as AbstractScalarHaWp::evaluate()).
+             *
+             * \param[in] packets The wavepackets. They must stay alive during the call.
+             * \return
+             * Complex 2D-Array of shape \f$ (P \times N) \f$,
+             * where \f$ P \f$ is the number of wavepackets.
+             */
+            CArray<Eigen::Dynamic,N> reduce(std::vector<Packet const*> const& packets) const
+            {
+                for (Packet const* packet : packets) {
+                    if (packet->shape()->n_entries() != (std::size_t)packet->coefficients().size())
+                        throw std::runtime_error("shape.size() != coefficients.size()");
+                }
+
+                std::vector< std::vector<std::size_t> > groups = group_(packets);
+
+                CArray<Eigen::Dynamic,N> result(packets.size(), is_real_ ? rgrid_.cols() : grid_.cols());
+
+                #pragma omp parallel
+                {
+                    HaWpEvaluatorWorkspace<N> workspace;
+
+                    #pragma omp for schedule(dynamic)
+                    for (std::size_t igroup = 0; igroup < groups.size(); igroup++) {
+                        std::vector<std::size_t> const& group = groups[igroup];
+
+                        Packet const* head = packets[group.front()];
+
+                        CMatrix<Eigen::Dynamic,Eigen::Dynamic> coefficients(group.size(), head->shape()->n_entries());
+                        for (std::size_t i = 0; i < group.size(); i++) {
+                            coefficients.row(i) = packets[group[i]]->coefficients().transpose();
+                        }
+
+                        CArray<Eigen::Dynamic,N> psi = create_evaluator_(*head).batch_reduce(coefficients, true, workspace);
+
+                        for (std::size_t i = 0; i < group.size(); i++) {
+                            result.row(group[i]) = psi.row(i);
+                        }
+                    }
+                }
+
+                return result;
+            }
+
+        private:
+            bool is_real_;
+            CMatrix<D,N> grid_;
+            RMatrix<D,N> rgrid_;
+
+            /**
+             * \brief Creates the evaluator of \p packet on the stored grid.
+             */
+            HaWpEvaluator<D,MultiIndex,N> create_evaluator_(Packet const& packet) const
+            {
+                if (is_real_)
+                    return packet.template create_evaluator<N>(rgrid_);
+                else
+                    return packet.template create_evaluator<N>(grid_);
+            }
+
+            /**
+             * \brief Returns true if both wavepackets can share one recursion.
+             */
+            static bool same_basis_(Packet const& lhs, Packet const& rhs)
+            {
+                HaWpParamSet<D> const& a = lhs.parameters();
+                HaWpParamSet<D> const& b = rhs.parameters();
+
+                return lhs.shape().get() == rhs.shape().get() &&
+                       lhs.eps() == rhs.eps() &&
+                       a.q() == b.q() && a.p() == b.p() &&
+                       a.Q() == b.Q() && a.P() == b.P();
+            }
+
+            /**
+             * \brief Partitions the wavepackets into groups that share one recursion.
+             *
+             * \return Indices of the wavepackets of each group.
+             */
+            static std::vector< std::vector<std::size_t> > group_(std::vector<Packet const*> const& packets)
+            {
+                std::vector< std::vector<std::size_t> > groups;
+
+                for (std::size_t i = 0; i < packets.size(); i++) {
+                    bool found = false;
+                    for (auto & group : groups) {
+                        if (same_basis_(*packets[group.front()], *packets[i])) {
+                            group.push_back(i);
+                            found = true;
+                            break;
+                        }
+                    }
+                    if (!found)
+                        groups.push_back(std::vector<std::size_t>(1, i));
+                }
+
+                return groups;
+            }
+        };
+    }
+}
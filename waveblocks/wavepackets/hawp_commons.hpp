@@ -6,6 +6,7 @@
 #include "hawp_paramset.hpp"
 #include "hawp_evaluator.hpp"
 #include "shapes/shape_extension_cache.hpp"
+#include "../utilities/atomic_shared_ptr.hpp"
 
 
 namespace waveblocks {
@@ -43,12 +44,29 @@ namespace waveblocks {
              */
             virtual shapes::ShapeEnumSharedPtr<D, MultiIndex> shape() const = 0;
 
-            template<int N> HaWpEvaluator<D,MultiIndex,N>
+            /**
+             * \brief Creates an evaluator for complex quadrature points.
+             *
+             * \tparam T Real scalar type of the basis values (see HaWpEvaluator).
+             * \tparam A Real scalar type of the accumulation (see HaWpEvaluator).
+             */
+            template<int N, class T = real_t, class A = T> HaWpEvaluator<D,MultiIndex,N,T,A>
             create_evaluator(CMatrix<D,N> const& grid) const
             {
                 return {eps(), &parameters(), shape().get(), grid};
             }
 
+            /**
+             * \brief Creates an evaluator for real quadrature points.
+             *
+             * The evaluator keeps \f$ x - q \f$ real (see HaWpEvaluator).
+             */
+            template<int N, class T = real_t, class A = T> HaWpEvaluator<D,MultiIndex,N,T,A>
+            create_evaluator(RMatrix<D,N> const& rgrid) const
+            {
+                return {eps(), &parameters(), shape().get(), rgrid};
+            }
+
             /**
              * \brief Evaluates all basis functions \f$ \{\phi_k\} \f$ on complex grid nodes \f$ x \in \gamma \f$.
              *
@@ -63,6 +81,47 @@ namespace waveblocks {
                 return create_evaluator(grid).all();
             }
 
+            /**
+             * \brief Evaluates all basis functions \f$ \{\phi_k\} \f$ on complex grid nodes \f$ x \in \gamma \f$
+             * with basis values of real scalar type \p T.
+             *
+             * Use <tt>evaluate_basis_as<float>(grid)</tt> for low-accuracy sampling.
+             *
+             * \return Complex 2D-array with shape (basis shape size, number of grid nodes)
+             */
+            template<class T, int N> HaWpBasisVector<N,T>
+            evaluate_basis_as(CMatrix<D,N> const& grid) const
+            {
+                return create_evaluator<N,T>(grid).all();
+            }
+
+            /**
+             * \brief Same as evaluate_basis_as(CMatrix<D,N> const&) for real grid nodes.
+             */
+            template<class T, int N> HaWpBasisVector<N,T>
+            evaluate_basis_as(RMatrix<D,N> const& rgrid) const
+            {
+                return create_evaluator<N,T>(rgrid).all();
+            }
+
+            /**
+             * \brief Evaluates all basis functions \f$ \{\phi_k\} \f$ on complex grid nodes \f$ x \in \gamma \f$
+             * using the given evaluation mode.
+             *
+             * Prefer HaWpEvaluationMode::PointTiles on large grids (e.g. from TensorProductQR).
+             *
+             * \param grid
+             * Complex grid nodes / quadrature points \f$ \gamma \f$.
+             * Complex matrix with shape (dimensionality, number of grid nodes).
+             * \param mode How the work is distributed among threads.
+             * \return Complex 2D-array with shape (basis shape size, number of grid nodes)
+             */
+            template<int N> HaWpBasisVector<N>
+            evaluate_basis(CMatrix<D,N> const& grid, HaWpEvaluationMode mode) const
+            {
+                return create_evaluator(grid).all(mode);
+            }
+
             /**
              * \brief Evaluates all basis functions \f$ \{\phi_k\} \f$ on real grid nodes \f$ x \in \gamma \f$.
              *
@@ -73,13 +132,22 @@ namespace waveblocks {
              *
              * \tparam N
              * Number of quadrature points.
-             * Don't choose Eigen::Dynamic. It works, but performance is bad.
+             * Eigen::Dynamic is evaluated in compile-time tiles (see HaWpEvaluator).
              */
             template<int N> HaWpBasisVector<N>
             evaluate_basis(RMatrix<D,N> const& rgrid) const
             {
-                CMatrix<D,N> cgrid = rgrid.template cast <complex_t>();
-                return evaluate_basis(cgrid);
+                return create_evaluator(rgrid).all();
+            }
+
+            /**
+             * \brief Evaluates all basis functions \f$ \{\phi_k\} \f$ on real grid nodes \f$ x \in \gamma \f$
+             * using the given evaluation mode.
+             */
+            template<int N> HaWpBasisVector<N>
+            evaluate_basis(RMatrix<D,N> const& rgrid, HaWpEvaluationMode mode) const
+            {
+                return create_evaluator(rgrid).all(mode);
             }
 
             //     virtual HaWpBasisVector<Eigen::Dynamic> evaluate_basis(ComplexGrid<D,Eigen::Dynamic> const& grid) const
@@ -95,8 +163,7 @@ namespace waveblocks {
              * Computing an extended shape is expensive. Therefore this function
              * caches computed extensions.
              *
-             * \e Thread-Safety: The stored pointer to the cached shape extension is not guarded by a mutex.
-             * Therefore race conditions may occur when calling this function concurrently.
+             * \e Thread-Safety: Concurrent calls are safe (see shapes::ShapeExtensionCache).
              *
              * \return Shared pointer to the extended shape.
              */
@@ -160,6 +227,46 @@ namespace waveblocks {
                 return this->template create_evaluator<N>(grid).reduce(coefficients());
             }
 
+            /**
+             * \brief Same as evaluate(CMatrix<D,N> const&), but reuses the slice buffers in \p workspace.
+             *
+             * Pass the same workspace in every call (e.g. in every time step) to avoid
+             * allocating the slice buffers again.
+             *
+             * \param grid
+             * Complex grid nodes / quadrature points \f$ \gamma \f$.
+             * Complex matrix with shape (dimensionality, number of grid nodes).
+             * \param workspace Slice buffers, see HaWpEvaluatorWorkspace.
+             * \return Complex matrix with shape (1, number of grid nodes)
+             */
+            template<int N> CArray<1,N>
+            evaluate(CMatrix<D,N> const& grid, HaWpEvaluatorWorkspace<N>& workspace) const
+            {
+                if (this->shape()->n_entries() != (std::size_t)coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                return this->template create_evaluator<N>(grid).reduce(coefficients(), workspace);
+            }
+
+            /**
+             * \brief Evaluates this wavepacket \f$ \Phi(x) \f$ at complex grid nodes \f$ x \in \gamma \f$
+             * using the given evaluation mode.
+             *
+             * \param grid
+             * Complex grid nodes / quadrature points \f$ \gamma \f$.
+             * Complex matrix with shape (dimensionality, number of grid nodes).
+             * \param mode How the work is distributed among threads.
+             * \return Complex matrix with shape (1, number of grid nodes)
+             */
+            template<int N> CArray<1,N>
+            evaluate(CMatrix<D,N> const& grid, HaWpEvaluationMode mode) const
+            {
+                if (this->shape()->n_entries() != (std::size_t)coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                return this->template create_evaluator<N>(grid).reduce(coefficients(), mode);
+            }
+
             /**
              * \brief Evaluates this wavepacket \f$ \Phi(x) \f$ at real grid nodes \f$ x \in \gamma \f$.
              *
@@ -175,8 +282,81 @@ namespace waveblocks {
             template<int N> CArray<1,N>
             evaluate(RMatrix<D,N> const& rgrid) const
             {
-                CMatrix<D,N> cgrid = rgrid.template cast <complex_t>();
-                return evaluate(cgrid);
+                if (this->shape()->n_entries() != (std::size_t)coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                return this->template create_evaluator<N>(rgrid).reduce(coefficients());
+            }
+
+            /**
+             * \brief Evaluates this wavepacket \f$ \Phi(x) \f$ at complex grid nodes \f$ x \in \gamma \f$
+             * in reduced or mixed precision.
+             *
+             * The basis values are computed in real scalar type \p T and summed up in \p A,
+             * e.g. <tt>evaluate_as<float,double>(grid)</tt> (see HaWpEvaluator).
+             *
+             * \return Complex matrix with shape (1, number of grid nodes)
+             */
+            template<class T, class A = T, int N> Eigen::Array<std::complex<A>,1,N>
+            evaluate_as(CMatrix<D,N> const& grid) const
+            {
+                if (this->shape()->n_entries() != (std::size_t)coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                return this->template create_evaluator<N,T,A>(grid).reduce(coefficients());
+            }
+
+            /**
+             * \brief Same as evaluate_as(CMatrix<D,N> const&) for real grid nodes.
+             */
+            template<class T, class A = T, int N> Eigen::Array<std::complex<A>,1,N>
+            evaluate_as(RMatrix<D,N> const& rgrid) const
+            {
+                if (this->shape()->n_entries() != (std::size_t)coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                return this->template create_evaluator<N,T,A>(rgrid).reduce(coefficients());
+            }
+
+            /**
+             * \brief Evaluates this wavepacket \f$ \Phi(x) \f$ and its gradient
+             * \f$ -i\varepsilon^2\nabla_x \Phi(x) \f$ at complex grid nodes \f$ x \in \gamma \f$.
+             *
+             * Both are computed in the same pass of the recursion (see HaWpEvaluator::reduce_gradient()),
+             * thus this is much cheaper than evaluating the HaWpGradient of this wavepacket.
+             * Notice that this function does not include the prefactor
+             * \f$ \frac{1}{\sqrt{det(Q)}} \f$ nor the global phase
+             * \f$ \exp{(\frac{iS}{\varepsilon^2})} \f$.
+             *
+             * \param grid
+             * Complex grid nodes / quadrature points \f$ \gamma \f$.
+             * Complex matrix with shape (dimensionality, number of grid nodes).
+             * \return
+             * Complex matrix with shape (1 + dimensionality, number of grid nodes).
+             * Row 0 contains \f$ \Phi \f$, row \f$ 1+d \f$ contains \f$ -i\varepsilon^2\partial_{x_d}\Phi \f$.
+             */
+            template<int N> CArray<Eigen::Dynamic,N>
+            evaluate_gradient(CMatrix<D,N> const& grid) const
+            {
+                if (this->shape()->n_entries() != (std::size_t)coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                return this->template create_evaluator<N>(grid).reduce_gradient(coefficients());
+            }
+
+            /**
+             * \brief Evaluates this wavepacket \f$ \Phi(x) \f$ and its gradient
+             * \f$ -i\varepsilon^2\nabla_x \Phi(x) \f$ at real grid nodes \f$ x \in \gamma \f$.
+             *
+             * \see evaluate_gradient(CMatrix<D,N> const&)
+             */
+            template<int N> CArray<Eigen::Dynamic,N>
+            evaluate_gradient(RMatrix<D,N> const& rgrid) const
+            {
+                if (this->shape()->n_entries() != (std::size_t)coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                return this->template create_evaluator<N>(rgrid).reduce_gradient(coefficients());
             }
 
             //     virtual HaWpBasisVector<Eigen::Dynamic> evaluate(ComplexGrid<D,Eigen::Dynamic> const& grid) const
@@ -277,6 +457,140 @@ namespace waveblocks {
         };
 
 
+        /**
+         * \brief Scalar Hagedorn wavepacket whose basis size \f$ |\mathfrak{K}| \f$ is known at compile-time.
+         *
+         * Same as ScalarHaWp, but the coefficients are a fixed-size vector. Propagators
+         * (see propagators::Propagator) pick this up and keep the interaction matrix \f$ F \f$
+         * and its exponential in fixed-size matrices too. Thus propagating a small basis
+         * (e.g. \f$ K = 4 \dots 16 \f$ in 1D) does not touch the heap for the coefficients.
+         *
+         * The basis shape must have exactly \p K entries.
+         *
+         * \tparam D wavepacket dimensionality
+         * \tparam MultiIndex type to represent a multi-index
+         * \tparam K number of basis functions \f$ |\mathfrak{K}| \f$
+         */
+        template<dim_t D, class MultiIndex, int K>
+        class StaticScalarHaWp : public AbstractScalarHaWpBasis<D, MultiIndex>
+        {
+        public:
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+            typedef CVector<K> StaticCoefficients;
+
+            /**
+             * \brief Grants writeable access to the semi-classical scaling parameter
+             * \f$ \varepsilon \f$ of the wavepacket.
+             */
+            real_t & eps()
+            {
+                return eps_;
+            }
+
+            real_t eps() const override
+            {
+                return eps_;
+            }
+
+            /**
+             * \brief Grants writeable access to the Hagedorn parameter set
+             * \f$ \Pi \f$ of the wavepacket.
+             */
+            HaWpParamSet<D> & parameters()
+            {
+                return parameters_;
+            }
+
+            HaWpParamSet<D> const& parameters() const override
+            {
+                return parameters_;
+            }
+
+            /**
+             * \brief Grants access to the basis shape
+             * \f$ \mathfrak{K} \f$ of the wavepacket.
+             *
+             * \return
+             * Reference to the shape enumeration pointer.
+             * You can assign a new pointer to it, as long as the new shape has \p K entries!
+             */
+            shapes::ShapeEnumSharedPtr<D, MultiIndex> & shape()
+            {
+                return shape_;
+            }
+
+            shapes::ShapeEnumSharedPtr<D, MultiIndex> shape() const override
+            {
+                return shape_;
+            }
+
+            /**
+             * \brief Grants writeable access to the coefficients \f$ c \f$
+             * of the wavepacket.
+             */
+            StaticCoefficients & coefficients()
+            {
+                return coefficients_;
+            }
+
+            StaticCoefficients const& coefficients() const
+            {
+                return coefficients_;
+            }
+
+            /**
+             * \brief Evaluates this wavepacket \f$ \Phi(x) \f$ at complex grid nodes \f$ x \in \gamma \f$.
+             *
+             * \see AbstractScalarHaWp::evaluate(CMatrix<D,N> const&)
+             */
+            template<int N> CArray<1,N>
+            evaluate(CMatrix<D,N> const& grid) const
+            {
+                if (this->shape()->n_entries() != std::size_t(K))
+                    throw std::runtime_error("shape.size() != K");
+
+                return this->template create_evaluator<N>(grid).reduce(coefficients_);
+            }
+
+            /**
+             * \brief Evaluates this wavepacket \f$ \Phi(x) \f$ at real grid nodes \f$ x \in \gamma \f$.
+             *
+             * \see AbstractScalarHaWp::evaluate(RMatrix<D,N> const&)
+             */
+            template<int N> CArray<1,N>
+            evaluate(RMatrix<D,N> const& rgrid) const
+            {
+                if (this->shape()->n_entries() != std::size_t(K))
+                    throw std::runtime_error("shape.size() != K");
+
+                return this->template create_evaluator<N>(rgrid).reduce(coefficients_);
+            }
+
+            /**
+             * \brief Computes the prefactor \f$ \frac{1}{\sqrt{det(Q)}} \f$.
+             */
+            complex_t prefactor() const
+            {
+                return real_t(1) / this->parameters().sdQ();
+            }
+
+            /**
+             * \brief Computes the global phase factor \f$ \exp{(\frac{i S}{\varepsilon^2})} \f$.
+             */
+            complex_t phasefactor() const
+            {
+                return std::exp(complex_t(0,1) * this->parameters().S() / eps() / eps());
+            }
+
+        private:
+            real_t eps_;
+            HaWpParamSet<D> parameters_;
+            shapes::ShapeEnumSharedPtr<D, MultiIndex> shape_;
+            StaticCoefficients coefficients_;
+        };
+
+
         /**
          * \brief Represents a homogeneous Hagedorn wavepacket \f$ \Psi \f$
          * with \f$ N \f$ components \f$ \Phi_n \f$.
@@ -501,35 +815,13 @@ namespace waveblocks {
             /**
              * \brief Computes the union of basis shapes of all components.
              *
-             * _Thread Safety:_ This function caches the basis shape union.
-             * The cache is not protected by a mutex. This concurrent access may
-             * introduce race conditions.
+             * _Thread Safety:_ This function caches the basis shape union
+             * and the maps from the union into the component's shapes.
+             * The cache is published atomically, thus concurrent calls of const member functions are safe.
              */
             shapes::ShapeEnumSharedPtr<D,MultiIndex> union_shape() const
             {
-                // check cache status
-                bool rebuild_cache = false;
-
-                if (union_cache_snapshot_.size() != n_components()) {
-                    rebuild_cache = true;
-                    union_cache_snapshot_.resize(n_components());
-                }
-
-                for (std::size_t n = 0; n < n_components() && !rebuild_cache; n++) {
-                    if (union_cache_snapshot_[n] != component(n).shape().get())
-                        rebuild_cache = true;
-                }
-
-                // rebuild cache if necessary
-                if (rebuild_cache) {
-                    std::vector< ShapeEnum<D,MultiIndex> const* > list(n_components());
-                    for (std::size_t c = 0; c < n_components(); c++) {
-                        list[c] = union_cache_snapshot_[c] = component(c).shape().get();
-                    }
-                    cached_shape_union_ = std::make_shared< ShapeEnum<D,MultiIndex> >(shapes::shape_enum::strict_union(list));
-                }
-
-                return cached_shape_union_;
+                return union_cache_()->shape;
             }
 
             /**
@@ -538,8 +830,7 @@ namespace waveblocks {
              * Evaluates \f$ \Psi(x) = \{\Phi_i(x)\} \f$,
              * where \f$ x \f$ is is a complex quadrature point.
              *
-             * _Thread Safety:_ Some intermediate results are cached. The cache is not
-             * protected by a mutex. Thus concurrent access may introduce race conditions.
+             * _Thread Safety:_ Concurrent calls are safe (see union_shape()).
              *
              * \param grid
              * Complex quadrature points.
@@ -549,26 +840,29 @@ namespace waveblocks {
              *
              * \tparam N
              * Number of quadrature points.
-             * Don't use Eigen::Dynamic. It works, but performance is bad.
+             * Eigen::Dynamic is evaluated in compile-time tiles (see HaWpEvaluator).
              */
             template<int N>
             CArray<Eigen::Dynamic,N> evaluate(CMatrix<D,N> const& grid) const
             {
-                ScalarHaWp<D,MultiIndex> unionwp;
-
-                unionwp.eps() = eps();
-                unionwp.parameters() = parameters();
-                unionwp.shape() = union_shape();
-
-                std::vector< ShapeEnum<D,MultiIndex>* > shape_list(n_components());
-                std::vector< complex_t const* > coeffs_list(n_components());
-
-                for (std::size_t n = 0; n < n_components(); n++) {
-                    shape_list[n] = component(n).shape().get();
-                    coeffs_list[n] = component(n).coefficients().data();
-                }
+                HaWpEvaluatorWorkspace<N> workspace;
+                return evaluate(grid, workspace);
+            }
 
-                return unionwp.template create_evaluator<N>(grid).vector_reduce(shape_list.data(), coeffs_list.data(), n_components());
+            /**
+             * \brief Same as evaluate(CMatrix<D,N> const&), but reuses the slice buffers in \p workspace.
+             *
+             * \param grid
+             * Complex quadrature points.
+             * Complex matrix of shape (dimensionality, number of quadrature points)
+             * \param workspace Slice buffers, see HaWpEvaluatorWorkspace.
+             * \return
+             * Complex matrix of shape (number of components, number of quadrature points)
+             */
+            template<int N>
+            CArray<Eigen::Dynamic,N> evaluate(CMatrix<D,N> const& grid, HaWpEvaluatorWorkspace<N>& workspace) const
+            {
+                return evaluate_(grid, workspace);
             }
 
             /**
@@ -585,22 +879,90 @@ namespace waveblocks {
              *
              * \tparam N
              * Number of quadrature points.
-             * Don't use Eigen::Dynamic. It works, but performance is bad.
+             * Eigen::Dynamic is evaluated in compile-time tiles (see HaWpEvaluator).
              */
             template<int N>
             CArray<Eigen::Dynamic,N> evaluate(RMatrix<D,N> const& rgrid) const
             {
-                CMatrix<D,N> cgrid = rgrid.template cast<complex_t>();
-                return evaluate(cgrid);
+                HaWpEvaluatorWorkspace<N> workspace;
+                return evaluate_(rgrid, workspace);
             }
 
         private:
+            /**
+             * \brief Union of the component's shapes and maps from the union into the component's shapes.
+             */
+            struct UnionCache
+            {
+                std::vector< std::weak_ptr< ShapeEnum<D,MultiIndex> > > sources;
+                shapes::ShapeEnumSharedPtr<D,MultiIndex> shape;
+                std::vector< std::vector<std::size_t> > subset_maps;
+            };
+
+            /**
+             * \brief Returns the union cache, rebuilds and publishes it, if a component's shape has changed.
+             *
+             * Concurrent rebuilds are harmless, since the registry hands out the same union to all of them.
+             */
+            std::shared_ptr<const UnionCache> union_cache_() const
+            {
+                std::shared_ptr<const UnionCache> cache = union_snapshot_.load();
+
+                bool valid = cache && cache->sources.size() == n_components();
+                for (std::size_t n = 0; n < n_components() && valid; n++)
+                    valid = utilities::same_owner(cache->sources[n], component(n).shape());
+
+                if (valid)
+                    return cache;
+
+                auto fresh = std::make_shared<UnionCache>();
+
+                std::vector< shapes::ShapeEnumSharedPtr<D,MultiIndex> > shapes(n_components());
+                for (std::size_t c = 0; c < n_components(); c++) {
+                    shapes[c] = component(c).shape();
+                    fresh->sources.push_back(shapes[c]);
+                }
+
+                // packets with identical component shapes share one union
+                fresh->shape = shapes::ShapeRegistry<D,MultiIndex>::instance().strict_union(shapes);
+
+                fresh->subset_maps.resize(n_components());
+                for (std::size_t c = 0; c < n_components(); c++) {
+                    fresh->subset_maps[c] = shapes::shape_enum::subset_map(fresh->shape.get(), shapes[c].get());
+                }
+
+                union_snapshot_.store(fresh);
+                return fresh;
+            }
+
+            /**
+             * \brief Implements evaluate() for complex and real grids.
+             */
+            template<class Grid, int N>
+            CArray<Eigen::Dynamic,N> evaluate_(Grid const& grid, HaWpEvaluatorWorkspace<N>& workspace) const
+            {
+                std::shared_ptr<const UnionCache> cache = union_cache_();
+
+                ScalarHaWp<D,MultiIndex> unionwp;
+
+                unionwp.eps() = eps();
+                unionwp.parameters() = parameters();
+                unionwp.shape() = cache->shape;
+
+                std::vector< complex_t const* > coeffs_list(n_components());
+
+                for (std::size_t n = 0; n < n_components(); n++) {
+                    coeffs_list[n] = component(n).coefficients().data();
+                }
+
+                return unionwp.template create_evaluator<N>(grid).vector_reduce(cache->subset_maps, coeffs_list.data(), workspace);
+            }
+
             real_t eps_;
             HaWpParamSet<D> parameters_;
             std::vector<Component> components_;
 
-            mutable std::vector< ShapeEnum<D,MultiIndex>* > union_cache_snapshot_;
-            mutable shapes::ShapeEnumSharedPtr<D,MultiIndex> cached_shape_union_;
+            mutable utilities::AtomicSharedPtr<const UnionCache> union_snapshot_;
         }; // class HomogeneousHaWp
 
 
@@ -840,7 +1202,7 @@ namespace waveblocks {
              *
              * \tparam N
              * Number of quadrature points.
-             * Don't use Eigen::Dynamic. It works, but performance is bad.
+             * Eigen::Dynamic is evaluated in compile-time tiles (see HaWpEvaluator).
              */
             template<int N>
             CArray<Eigen::Dynamic,N> evaluate(CMatrix<D,N> const& grid) const
@@ -868,13 +1230,18 @@ namespace waveblocks {
              *
              * \tparam N
              * Number of quadrature points.
-             * Don't use Eigen::Dynamic. It works, but performance is bad.
+             * Eigen::Dynamic is evaluated in compile-time tiles (see HaWpEvaluator).
              */
             template<int N>
             CArray<Eigen::Dynamic,N> evaluate(RMatrix<D,N> const& rgrid) const
             {
-                CMatrix<D,N> cgrid = rgrid.template cast<complex_t>();
-                return evaluate(cgrid);
+                CArray<Eigen::Dynamic,N> result(n_components(),rgrid.cols());
+
+                for (std::size_t c = 0; c < n_components(); c++) {
+                    result.row(c) = component(c).evaluate(rgrid);
+                }
+
+                return result;
             }
 
         private:
@@ -1,9 +1,20 @@
 #pragma once
 
 #include <functional>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
 
 #include <Eigen/Core>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "../math/pi.hpp"
 #include "../math/kahan_sum.hpp"
 
@@ -16,6 +27,121 @@ namespace waveblocks {
     namespace wavepackets {
         using shapes::ShapeEnum;
         using shapes::ShapeSlice;
+        using shapes::ShapeSliceLinks;
+
+        /**
+         * \brief Selects how HaWpEvaluator distributes the work among OpenMP threads.
+         */
+        enum class HaWpEvaluationMode
+        {
+            /**
+             * The nodes of each slice are split among the threads.
+             * Every slice opens a parallel region, thus small slices (e.g. \f$ D = 1 \f$)
+             * are dominated by fork/join overhead.
+             */
+            Slices,
+
+            /**
+             * The quadrature points are split into tiles. Each thread runs the whole
+             * recursion on its tiles without synchronization between slices.
+             * Scales well on large grids, but needs at least one tile per thread.
+             */
+            PointTiles,
+
+            /**
+             * If the basis is separable (see HaWpEvaluator::separable()), it is evaluated as tensor products
+             * of one-dimensional recursions, otherwise same as Slices.
+             * Much faster on full boxes, but reduce() contracts with plain matrix products
+             * instead of Kahan's algorithm and its temporaries grow with the basis size.
+             */
+            Separable
+        };
+
+        /**
+         * \brief Preallocated slice buffers for HaWpEvaluator.
+         *
+         * The slice-by-slice evaluation keeps three slices alive: the previous, the current and the next one.
+         * A workspace stores them in three ring buffers sized to the largest slice.
+         * Keep a workspace alive across evaluations (e.g. over all time steps of a propagation)
+         * to evaluate wavepackets without allocating slice memory.
+         * The buffers only grow, if a larger basis shape comes along.
+         *
+         * Dynamically sized grids are evaluated in compile-time tiles (see HaWpEvaluator).
+         * For them, the workspace keeps three split-complex tile buffers per OpenMP thread instead.
+         *
+         * A workspace must not be used by two evaluations at the same time.
+         *
+         * \tparam N Number of quadrature points.
+         * \tparam T Real scalar type of the basis values.
+         */
+        template<int N, class T = real_t>
+        class HaWpEvaluatorWorkspace
+        {
+        public:
+            /**
+             * Width of the compile-time tiles used for dynamically sized grids.
+             */
+            static const int TileWidth = 8;
+
+            /**
+             * Basis values of one slice restricted to a compile-time tile of quadrature points
+             * in split-complex layout: The first TileWidth columns hold the real parts,
+             * the last TileWidth columns hold the imaginary parts.
+             * Rows are contiguous to allow full-width SIMD.
+             */
+            typedef Eigen::Array<T,Eigen::Dynamic,2*TileWidth,Eigen::RowMajor> TileBuffer;
+
+            /**
+             * \brief Makes sure that every buffer holds at least \p max_slice_size basis functions
+             * on \p npts quadrature points.
+             */
+            void reserve(std::size_t max_slice_size, int npts)
+            {
+                for (auto & buffer : buffers_) {
+                    if ((std::size_t)buffer.rows() < max_slice_size || buffer.cols() != npts)
+                        buffer.resize(std::max<std::size_t>(max_slice_size, buffer.rows()), npts);
+                }
+            }
+
+            /**
+             * \brief Returns the ring buffer that stores slice \p islice.
+             *
+             * \param[in] islice Ordinal of the slice (-1 is allowed).
+             */
+            HaWpBasisVector<N,T>& buffer(int islice)
+            {
+                return buffers_[(islice + 3) % 3];
+            }
+
+            /**
+             * \brief Makes sure that there are tile buffers for \p nthreads threads,
+             * each holding at least \p max_slice_size basis functions.
+             */
+            void reserve_tiles(int nthreads, std::size_t max_slice_size)
+            {
+                if ((int)tiles_.size() < nthreads)
+                    tiles_.resize(nthreads);
+
+                for (auto & buffers : tiles_) {
+                    for (auto & buffer : buffers) {
+                        if ((std::size_t)buffer.rows() < max_slice_size)
+                            buffer.resize(max_slice_size, 2*TileWidth);
+                    }
+                }
+            }
+
+            /**
+             * \brief Returns the three tile buffers of thread \p thread.
+             */
+            std::array< TileBuffer, 3 >& tiles(int thread)
+            {
+                return tiles_[thread];
+            }
+
+        private:
+            std::array< HaWpBasisVector<N,T>, 3 > buffers_;
+            std::vector< std::array< TileBuffer, 3 > > tiles_;
+        };
 
         /**
          * \brief Evaluates a wavepacket slice by slice.
@@ -35,17 +161,56 @@ namespace waveblocks {
          * \tparam MulitIndex The type used to represent multi-indices.
          * \tparam N
          * Number of quadrature points.
-         * Don't use Eigen::Dynamic. It works, but performance is bad.
+         * If Eigen::Dynamic, all(), reduce() and batch_reduce() (thus vector_reduce()) internally
+         * process the points in compile-time tiles of FixedTileWidth points.
+         * The tiles keep real and imaginary parts in separate planes (split-complex layout),
+         * thus the recursion is a sequence of real multiply-adds over contiguous rows,
+         * which the compiler maps onto full-width SIMD registers (SSE2, AVX2 or AVX-512,
+         * depending on the target architecture flags, e.g. -march=native).
+         * \tparam T
+         * Real scalar type of the basis values and the recursion.
+         * Use float to sample wavepackets at twice the SIMD width and half the memory traffic,
+         * e.g. for visualization. The seed \f$ \phi_0 \f$ and \f$ Q^{-1} \f$ are always computed in real_t.
+         * \tparam A
+         * Real scalar type used to accumulate the contractions with the coefficients
+         * (reduce(), batch_reduce(), reduce_gradient()) and of their results.
+         * Use float basis values with double accumulation to limit the error growth of long sums.
          */
-        template<dim_t D, class MultiIndex, int N>
+        template<dim_t D, class MultiIndex, int N, class T = real_t, class A = T>
         class HaWpEvaluator
         {
         public:
+            typedef std::complex<T> complex_type;
+            typedef std::complex<A> accum_type;
+
             typedef Eigen::Matrix<complex_t,D,D> CMatrixDD;
-            typedef Eigen::Array<complex_t,1,N> CArray1N;
             typedef Eigen::Matrix<complex_t,D,N> CMatrixDN;
             typedef Eigen::Matrix<real_t,D,N> RMatrixDN;
 
+            typedef Eigen::Matrix<complex_type,D,D> TMatrixDD;
+            typedef Eigen::Matrix<complex_type,D,N> TMatrixDN;
+            typedef Eigen::Array<complex_type,1,N> CArray1N;
+
+            typedef HaWpBasisVector<N,T> BasisVector;
+            typedef HaWpEvaluatorWorkspace<N,T> Workspace;
+
+            /**
+             * Results of the contractions with the coefficients.
+             */
+            typedef Eigen::Array<accum_type,1,N> ResultArray1N;
+            typedef Eigen::Array<accum_type,Eigen::Dynamic,N> ResultArrayXN;
+
+            /**
+             * Basis values of one slice, possibly a block of a larger array.
+             */
+            typedef Eigen::Ref< BasisVector, 0, Eigen::OuterStride<> > BasisRef;
+            typedef Eigen::Ref< const BasisVector, 0, Eigen::OuterStride<> > ConstBasisRef;
+
+            /**
+             * Coefficient vector of any storage (e.g. fixed-size), passed without a copy.
+             */
+            typedef Eigen::Ref< const Coefficients > CoefficientsRef;
+
         private:
             real_t eps_;
             const HaWpParamSet<D>* parameters_;
@@ -61,6 +226,16 @@ namespace waveblocks {
              */
             CMatrixDN dx_;
 
+            /**
+             * precomputed expression: x - q on real grids (dx_ stays empty)
+             */
+            RMatrixDN rdx_;
+
+            /**
+             * true if constructed from real quadrature points
+             */
+            bool real_grid_;
+
             /**
              * precomputed expression: Q^{-1}
              */
@@ -69,17 +244,17 @@ namespace waveblocks {
             /**
              * precomputed expression: Q^H * Q^{-T}
              */
-            CMatrixDD Qh_Qinvt_;
+            TMatrixDD Qh_Qinvt_;
 
             /**
              * precomputed expression: Q^{-1} * (x - q)
              */
-            CMatrixDN Qinv_dx_;
+            TMatrixDN Qinv_dx_;
 
             /**
-             * lookup-table for sqrt
+             * true if the basis factorizes into one-dimensional recursions
              */
-            std::vector<real_t> sqrt_;
+            bool separable_;
 
         public:
             /**
@@ -98,7 +273,7 @@ namespace waveblocks {
                 , parameters_(parameters)
                 , enumeration_(enumeration)
                 , npts_(x.cols())
-                , sqrt_()
+                , real_grid_(false)
             {
                 RMatrix<D,1> const& q = parameters_->q();
                 CMatrix<D,D> const& Q = parameters_->Q();
@@ -106,20 +281,60 @@ namespace waveblocks {
                 // precompute ...
                 dx_ = x.colwise() - q.template cast<complex_t>();
                 Qinv_ = Q.inverse();
-                Qh_Qinvt_ = Q.adjoint()*Qinv_.transpose();
-                Qinv_dx_ = Qinv_*dx_;
+                Qh_Qinvt_ = (Q.adjoint()*Qinv_.transpose()).template cast<complex_type>();
+                Qinv_dx_ = (Qinv_*dx_).template cast<complex_type>();
 
-                //precompute sqrt lookup table
-                {
-                    int limit = 0;
-                    for (dim_t d = 0; d < D; d++)
-                        limit = std::max(limit, enumeration_->limit(d) );
+                separable_ = is_separable_();
+            }
+
+            /**
+             * \brief Specialization for real quadrature points.
+             *
+             * \f$ x - q \f$ is kept real, thus it needs half the memory and
+             * all products with it are real-by-complex products.
+             *
+             * \param[in] eps The semi-classical scaling parameter \f$ \varepsilon \f$ of the wavepacket.
+             * \param[in] parameters The Hagedorn parameter set \f$ \Pi \f$ of the wavepacket.
+             * \param[in] enumeration The basis shape \f$ \mathfrak{K} \f$ of the wavepacket.
+             * \param[in] x Quadrature points: Real matrix of shape \f$ (D \times N) \f$, where \f$ N \f$ number of quadrature points).
+             */
+            HaWpEvaluator(real_t eps,
+                          const HaWpParamSet<D>* parameters,
+                          const ShapeEnum<D,MultiIndex>* enumeration,
+                          const RMatrixDN &x)
+                : eps_(eps)
+                , parameters_(parameters)
+                , enumeration_(enumeration)
+                , npts_(x.cols())
+                , real_grid_(true)
+            {
+                RMatrix<D,1> const& q = parameters_->q();
+                CMatrix<D,D> const& Q = parameters_->Q();
 
-                    sqrt_.resize(limit+2);
+                // precompute ...
+                rdx_ = x.colwise() - q;
+                Qinv_ = Q.inverse();
+                Qh_Qinvt_ = (Q.adjoint()*Qinv_.transpose()).template cast<complex_type>();
 
-                    for (int i = 0; i <= limit+1; i++)
-                        sqrt_[i] = std::sqrt( real_t(i) );
-                }
+                // complex-by-real product: two real products instead of one complex product
+                Qinv_dx_.resize(D, npts_);
+                Qinv_dx_.real() = (Qinv_.real()*rdx_).template cast<T>();
+                Qinv_dx_.imag() = (Qinv_.imag()*rdx_).template cast<T>();
+
+                separable_ = is_separable_();
+            }
+
+            /**
+             * \brief Tells whether the basis factorizes into one-dimensional recursions.
+             *
+             * This is the case if \f$ Q \f$ and \f$ P \f$ are diagonal and the basis shape
+             * is a full box, e.g. a HyperCubicShape. Then HaWpEvaluationMode::Separable evaluates \f$ D \f$
+             * one-dimensional recursions of length \f$ K_d + 1 \f$ and combines them as tensor products
+             * instead of running the recursion over all nodes.
+             */
+            bool separable() const
+            {
+                return separable_;
             }
 
             /**
@@ -130,16 +345,25 @@ namespace waveblocks {
             CArray1N seed() const
             {
                 RMatrix<D,1> const& p = parameters_->p();
-                CMatrix<D,D> const& P = parameters_->P();
 
-                CMatrixDN P_Qinv_dx = P*Qinv_dx_;
+                // the exponent is large and cancels, thus it is computed in real_t
+                CMatrixDN P_Qinv_dx = P_Qinv_dx_();
 
-                CArray1N pr1 = ( dx_.array() * P_Qinv_dx.array() ).colwise().sum();
-                CArray1N pr2 = ( p.transpose()*dx_ ).array();
+                CArray<1,N> pr1(1, npts_);
+                CArray<1,N> pr2(1, npts_);
 
-                CArray1N e = complex_t(0.0, 1.0)/(eps_*eps_) * (0.5*pr1 + pr2);
+                if (real_grid_) {
+                    pr1 = ( rdx_.array() * P_Qinv_dx.array() ).colwise().sum();
+                    pr2 = ( p.transpose()*rdx_ ).array().template cast<complex_t>();
+                }
+                else {
+                    pr1 = ( dx_.array() * P_Qinv_dx.array() ).colwise().sum();
+                    pr2 = ( p.transpose()*dx_ ).array();
+                }
 
-                return e.exp() / std::pow(math::pi<real_t>()*eps_*eps_, D/4.0);
+                CArray<1,N> e = complex_t(0.0, 1.0)/(eps_*eps_) * (0.5*pr1 + pr2);
+
+                return ( e.exp() / std::pow(math::pi<real_t>()*eps_*eps_, D/4.0) ).template cast<complex_type>();
             }
 
             /**
@@ -147,123 +371,174 @@ namespace waveblocks {
              * this member function computes basis function values
              * on the next slice (using recursive evaluation formula).
              *
+             * This overload writes into caller-provided storage and does not allocate memory.
+             * The arguments may be blocks of larger arrays (e.g. rows of a HaWpEvaluatorWorkspace buffer).
+             *
              * Hint: Use function seed() to bootstrap recursion.
              *
              * \param[in] islice Ordinal of current slice.
              * \param[in] prev_basis
              * Basis values on previous slice.
-             * Type: Complex 2D-array of shape \f$ (S \times N) \f$,
-             * where \f$ S \f$ is the number of nodes in the current slice
+             * Type: Complex 2D-array of shape \f$ (S^- \times N) \f$,
+             * where \f$ S^- \f$ is the number of nodes in the previous slice
              * and \f$ N \f$ is the number of quadrature points.
-             * \param[in] curr_basis B
+             * \param[in] curr_basis
              * Basis values on current slice.
              * Type: Complex 2D-array of shape \f$ (S \times N) \f$
-             *
-             * \return
+             * \param[out] next_basis
              * Computed basis values on next slice.
              * Type: Complex 2D-Array of shape \f$ (S^+ \times N) \f$,
              * where \f$ S^+ \f$ is the number of nodes in the next slice.
              */
-            HaWpBasisVector<N> step(std::size_t islice,
-                                    const HaWpBasisVector<N>& prev_basis,
-                                    const HaWpBasisVector<N>& curr_basis) const
+            void step(std::size_t islice,
+                      ConstBasisRef prev_basis,
+                      ConstBasisRef curr_basis,
+                      BasisRef next_basis) const
             {
                 auto & prev_enum = enumeration_->slice(islice-1);
                 auto & curr_enum = enumeration_->slice(islice);
                 auto & next_enum = enumeration_->slice(islice+1);
 
+                // precomputed neighbour links replace the binary searches within the slices
+                auto & curr_links = enumeration_->links(islice);
+                auto & next_links = enumeration_->links(islice+1);
+
                 assert ((int)prev_enum.size() == prev_basis.rows());
                 assert ((int)curr_enum.size() == curr_basis.rows());
+                assert ((int)next_enum.size() == next_basis.rows());
+                (void)prev_enum;
+                (void)curr_enum;
 
-                HaWpBasisVector<N> next_basis(next_enum.size(), npts_);
-
-                #pragma omp parallel
-                {
-                    // pre-allocate
-                    CArray<1,N> pr1(1,npts_), pr2(1,npts_);
-
-                    //loop over all multi-indices within next slice [j = position of multi-index within next slice]
-                    #pragma omp for
-                    for (std::size_t j = 0; j < next_enum.size(); j++) {
-                        std::array<int,D> next_index = next_enum[j];
-                        //find valid precursor: find first non-zero entry
-                        dim_t axis = D;
-                        for (dim_t d = 0; d < D; d++) {
-                            if (next_index[d] != 0) {
-                                axis = d;
-                                break;
-                            }
-                        }
-
-                        assert(axis != D); //assert that multi-index contains some non-zero entries
+                //loop over all multi-indices within next slice [j = position of multi-index within next slice]
+                #pragma omp parallel for
+                for (std::size_t j = 0; j < next_enum.size(); j++) {
+                    //valid precursor: first non-zero entry
+                    dim_t axis = next_links.axis[j];
 
+                    assert(axis != D); //assert that multi-index contains some non-zero entries
 
-                        // compute contribution of current slice
-                        std::array<int,D> curr_index = next_index;
-                        curr_index[axis] -= 1; //get backward neighbour
-                        std::size_t curr_ordinal = curr_enum.find(curr_index);
+                    std::size_t curr_ordinal = next_links.backward[j*D + axis]; //backward neighbour
 
-                        assert(curr_ordinal < curr_enum.size()); //assert that multi-index has been found within current slice
+                    assert(curr_ordinal < curr_enum.size()); //assert that multi-index has been found within current slice
+                    (void)curr_ordinal;
 
-                        pr1 = curr_basis.row(curr_ordinal) * Qinv_dx_.row(axis).array() * std::sqrt(2.0)/eps_ ;
-
-
-                        // compute contribution of previous slice
-                        std::array< std::size_t,D > prev_ordinals = prev_enum.find_backward_neighbours(curr_index);
-
-                        pr2.setZero();
-
-                        for (dim_t d = 0; d < D; d++) {
-                            if (curr_index[d] != 0) {
-                                pr2 += prev_basis.row(prev_ordinals[d]) * Qh_Qinvt_(axis,d) * sqrt_[ curr_index[d] ];
-                            }
-                        }
+                    step_row_(curr_links, next_links, j, prev_basis, curr_basis, next_basis.row(j), Qinv_dx_);
+                }
+            }
 
+            /**
+             * \brief Having basis function values on previous and current slice,
+             * this member function computes basis function values
+             * on the next slice (using recursive evaluation formula).
+             *
+             * Hint: Use function seed() to bootstrap recursion.
+             *
+             * \param[in] islice Ordinal of current slice.
+             * \param[in] prev_basis
+             * Basis values on previous slice.
+             * Type: Complex 2D-array of shape \f$ (S \times N) \f$,
+             * where \f$ S \f$ is the number of nodes in the current slice
+             * and \f$ N \f$ is the number of quadrature points.
+             * \param[in] curr_basis B
+             * Basis values on current slice.
+             * Type: Complex 2D-array of shape \f$ (S \times N) \f$
+             *
+             * \return
+             * Computed basis values on next slice.
+             * Type: Complex 2D-Array of shape \f$ (S^+ \times N) \f$,
+             * where \f$ S^+ \f$ is the number of nodes in the next slice.
+             */
+            BasisVector step(std::size_t islice,
+                                    const BasisVector& prev_basis,
+                                    const BasisVector& curr_basis) const
+            {
+                BasisVector next_basis(enumeration_->slice(islice+1).size(), npts_);
 
-                        // compute basis value within next slice
-                        next_basis.row(j) = (pr1 - pr2) / sqrt_[ 1+curr_index[axis] ];
-                    }
+                step(islice, prev_basis, curr_basis, next_basis);
 
-                }
                 return next_basis;
             }
 
             /**
              * \brief Evaluates all basis functions.
              *
+             * The recursion runs directly on the rows of the returned array,
+             * thus no slice buffers are needed.
+             *
              * \return
              * Complex 2D-Array of shape \f$ (|\mathfrak{K}| \times N) \f$,
              * where \f$ N \f$ is the number of quadrature points.
              */
-            HaWpBasisVector<N> all() const
+            BasisVector all() const
             {
-                HaWpBasisVector<N> complete_basis(enumeration_->n_entries(), npts_);
-                //HaWpBasisVector<N> complete_basis = HaWpBasisVector<N>::Zero(enumeration_->n_entries(), npts_);
-                //~ std::cout << "complete_basis (init):\n" << complete_basis << "\n";
-                //~ std::cout << "complete_basis.shape: " << complete_basis.rows() << ", " << complete_basis.cols() << "\n";
+                if (N == Eigen::Dynamic)
+                    return all_fixed_tiles_();
 
-                HaWpBasisVector<N> prev_basis(0,npts_);
-                HaWpBasisVector<N> curr_basis(0,npts_);
-                HaWpBasisVector<N> next_basis(1,npts_);
+                BasisVector complete_basis(enumeration_->n_entries(), npts_);
 
-                complete_basis.block(0, 0, 1, npts_) = next_basis = seed();
+                complete_basis.row(0) = seed();
 
                 for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
-                    prev_basis = std::move(curr_basis);
-                    curr_basis = std::move(next_basis);
+                    step(islice,
+                         slice_rows_(complete_basis, islice-1),
+                         slice_rows_(complete_basis, islice),
+                         slice_rows_(complete_basis, islice+1));
+                }
 
-                    next_basis = step(islice, prev_basis, curr_basis);
+                return complete_basis;
+            }
 
-                    std::size_t offset = enumeration_->slice(islice+1).offset();
+            /**
+             * \brief Evaluates all basis functions, parallelized over tiles of quadrature points.
+             *
+             * The quadrature points are split into tiles of \p tile_size points. Each thread
+             * runs the whole slice recursion on its tiles, thus there is no barrier between slices
+             * and the working set of a tile stays in cache. Results are identical to all().
+             *
+             * \param[in] tile_size Number of quadrature points per tile, 0 selects a cache-sized default.
+             * \return
+             * Complex 2D-Array of shape \f$ (|\mathfrak{K}| \times N) \f$,
+             * where \f$ N \f$ is the number of quadrature points.
+             */
+            BasisVector all_tiled(long tile_size = 0) const
+            {
+                BasisVector complete_basis(enumeration_->n_entries(), npts_);
+
+                complete_basis.row(0) = seed();
+
+                const long tile = tile_size_(tile_size);
+                const long ntiles = (npts_ + tile - 1) / tile;
 
-                    //~ std::cout << "offset: " << offset << ", next_basis.rows: " << next_basis.rows() << "\n";
+                #pragma omp parallel for schedule(static)
+                for (long itile = 0; itile < ntiles; itile++) {
+                    const long col = itile*tile;
+                    const long ncols = std::min<long>(tile, npts_ - col);
 
-                    complete_basis.block(offset, 0, next_basis.rows(), npts_) = next_basis;
+                    for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
+                        step_tile_(islice,
+                                   slice_block_(complete_basis, islice-1, col, ncols),
+                                   slice_block_(complete_basis, islice, col, ncols),
+                                   slice_block_(complete_basis, islice+1, col, ncols),
+                                   col);
+                    }
                 }
 
                 return complete_basis;
             }
 
+            /**
+             * \brief Evaluates all basis functions using the given evaluation mode.
+             */
+            BasisVector all(HaWpEvaluationMode mode) const
+            {
+                if (mode == HaWpEvaluationMode::PointTiles)
+                    return all_tiled();
+                else if (mode == HaWpEvaluationMode::Separable && separable_)
+                    return all_separable_();
+                else
+                    return all();
+            }
+
             /**
              * \brief Evaluates wavepacket in a memory efficient manner.
              *
@@ -277,38 +552,96 @@ namespace waveblocks {
              * Complex 2D-Array of shape \f$ (1 \times N) \f$,
              * where \f$ N \f$ is the number of quadrature points.
              */
-            CArray<1,N> reduce(const Coefficients& coefficients) const
+            ResultArray1N reduce(CoefficientsRef coefficients) const
             {
-                // use Kahan's algorithm to accumulate bases with O(1) numerical error instead of O(Sqrt(N))
-                math::KahanSum< CArray<1,N> > psi( CArray<1,N>::Zero(1,npts_) );
-
-                HaWpBasisVector<N> prev_basis(0,npts_);
-                HaWpBasisVector<N> curr_basis(0,npts_);
-                HaWpBasisVector<N> next_basis(1,npts_);
-
-                next_basis = seed();
-
-                psi += next_basis.row(0)*coefficients[0];
-
-                for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
-                    prev_basis = std::move(curr_basis);
-                    curr_basis = std::move(next_basis);
+                Workspace workspace;
+                return reduce(coefficients, workspace);
+            }
 
-                    next_basis = step(islice, prev_basis, curr_basis);
+            /**
+             * \brief Same as reduce(CoefficientsRef), but keeps the slice buffers in \p workspace.
+             *
+             * Reuse the workspace across calls to avoid allocating the slice buffers again.
+             *
+             * The quadrature points are split into chunks of ReduceChunkWidth points. Each chunk runs
+             * the whole slice recursion and its contraction within one parallel region.
+             * Every point is summed up in the same order, thus the result is bitwise reproducible
+             * and independent of the number of threads.
+             *
+             * If the number of quadrature points is not known at compile-time, the recursion runs
+             * in compile-time tiles instead, since the rows of the column-major slice buffers are strided.
+             * Then the workspace keeps the tile buffers of each thread.
+             *
+             * \param[in] coefficients Vector of wavepacket coefficients, length is \f$ |\mathfrak{K}| \f$.
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             * \return
+             * Complex 2D-Array of shape \f$ (1 \times N) \f$,
+             * where \f$ N \f$ is the number of quadrature points.
+             */
+            ResultArray1N reduce(CoefficientsRef coefficients, Workspace& workspace) const
+            {
+                if (N == Eigen::Dynamic)
+                    return reduce_fixed_tiles_(coefficients, workspace);
 
-                    std::size_t offset = enumeration_->slice(islice+1).offset();
+                return reduce_chunks_(coefficients, workspace, ReduceChunkWidth);
+            }
 
-                    for (long j = 0; j < next_basis.rows(); j++) {
-                        complex_t cj = coefficients[offset + j];
+            /**
+             * \brief Evaluates wavepacket in a memory efficient manner, parallelized over tiles of quadrature points.
+             *
+             * Same as reduce(), but each thread runs the whole slice recursion on its own tiles
+             * of quadrature points (see all_tiled()).
+             *
+             * \param[in] coefficients Vector of wavepacket coefficients, length is \f$ |\mathfrak{K}| \f$.
+             * \param[in] tile_size Number of quadrature points per tile, 0 selects a cache-sized default.
+             * \return
+             * Complex 2D-Array of shape \f$ (1 \times N) \f$,
+             * where \f$ N \f$ is the number of quadrature points.
+             */
+            ResultArray1N reduce_tiled(CoefficientsRef coefficients, long tile_size = 0) const
+            {
+                Workspace workspace;
+                return reduce_tiled(coefficients, workspace, tile_size);
+            }
 
-                        //prints: multi-index -> basis -> coefficient
-                        //std::cout << enumeration->slice(islice+1)[j] << " -> " << next_basis.row(j).matrix() << " * " << cj << std::endl;
+            /**
+             * \brief Same as reduce_tiled(CoefficientsRef, long), but keeps the slice buffers in \p workspace.
+             *
+             * The tiles run on disjoint columns of the workspace buffers, thus no thread allocates memory.
+             *
+             * \param[in] coefficients Vector of wavepacket coefficients, length is \f$ |\mathfrak{K}| \f$.
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             * \param[in] tile_size Number of quadrature points per tile, 0 selects a cache-sized default.
+             */
+            ResultArray1N reduce_tiled(CoefficientsRef coefficients, Workspace& workspace, long tile_size = 0) const
+            {
+                return reduce_chunks_(coefficients, workspace, tile_size_(tile_size));
+            }
 
-                        psi += next_basis.row(j)*cj;
-                    }
-                }
+            /**
+             * \brief Evaluates wavepacket in a memory efficient manner using the given evaluation mode.
+             */
+            ResultArray1N reduce(CoefficientsRef coefficients, HaWpEvaluationMode mode) const
+            {
+                if (mode == HaWpEvaluationMode::PointTiles)
+                    return reduce_tiled(coefficients);
+                else if (mode == HaWpEvaluationMode::Separable && separable_)
+                    return reduce_separable_(coefficients);
+                else
+                    return reduce(coefficients);
+            }
 
-                return psi();
+            /**
+             * \brief Same as reduce(CoefficientsRef, HaWpEvaluationMode), but keeps the slice buffers in \p workspace.
+             */
+            ResultArray1N reduce(CoefficientsRef coefficients, Workspace& workspace, HaWpEvaluationMode mode) const
+            {
+                if (mode == HaWpEvaluationMode::PointTiles)
+                    return reduce_tiled(coefficients, workspace);
+                else if (mode == HaWpEvaluationMode::Separable && separable_)
+                    return reduce_separable_(coefficients);
+                else
+                    return reduce(coefficients, workspace);
             }
 
             /**
@@ -326,65 +659,69 @@ namespace waveblocks {
              * Complex 2D-Array of shape \f$ (C \times N) \f$,
              * where \f$ N \f$ is the number of quadrature points.
              */
-            CArray<Eigen::Dynamic,N> vector_reduce(ShapeEnum<D,MultiIndex> ** subset_enums,
+            ResultArrayXN vector_reduce(ShapeEnum<D,MultiIndex> ** subset_enums,
                                                    complex_t const ** subset_coeffs,
                                                    std::size_t n_components) const
             {
-                // use Kahan's algorithm to accumulate bases with O(1) numerical error instead of O(Sqrt(N))
-                std::vector< math::KahanSum< CArray<1,N> > > psi(n_components);
-
-                HaWpBasisVector<N> prev_basis(0,npts_);
-                HaWpBasisVector<N> curr_basis(0,npts_);
-                HaWpBasisVector<N> next_basis(1,npts_);
+                Workspace workspace;
+                return vector_reduce(subset_enums, subset_coeffs, n_components, workspace);
+            }
 
-                next_basis = seed();
+            /**
+             * \brief Same as vector_reduce(ShapeEnum<D,MultiIndex>**, complex_t const**, std::size_t),
+             * but keeps the slice buffers in \p workspace.
+             *
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             */
+            ResultArrayXN vector_reduce(ShapeEnum<D,MultiIndex> ** subset_enums,
+                                                   complex_t const ** subset_coeffs,
+                                                   std::size_t n_components,
+                                                   Workspace& workspace) const
+            {
+                std::vector< std::vector<std::size_t> > subset_maps(n_components);
 
                 for (std::size_t n = 0; n < n_components; n++) {
-                    psi[n] = math::KahanSum< CArray<1,N> >( CArray<1,N>::Zero(1,npts_)); // zero initialize
-                    psi[n] += subset_coeffs[n][0]*next_basis.row(0).matrix();
+                    subset_maps[n] = shapes::shape_enum::subset_map(enumeration_, subset_enums[n]);
                 }
 
-                for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
-                    prev_basis = std::move(curr_basis);
-                    curr_basis = std::move(next_basis);
-
-                    next_basis = step(islice, prev_basis, curr_basis);
-
-                    ShapeSlice<D,MultiIndex> const& superset_slice = enumeration_->slice(islice+1);
+                return vector_reduce(subset_maps, subset_coeffs, workspace);
+            }
 
-                    //             for (std::size_t n = 0; n < n_components; n++) {
-                    //                 ShapeSlice<D,MultiIndex> const& subset_slice = subset_enums[n]->slice(islice+1);
-                    //                 HaWpBasisVector<N> subset_basis = shape_enum::copy_subset(next_basis, superset_slice, subset_slice);
-                    //
-                    //                 for (long j = 0; j < subset_basis.rows(); j++) {
-                    //                     complex_t cj = subset_coeffs[n][subset_slice.offset() + j];
-                    //
-                    //                     psi[n] += cj*subset_basis.row(j);
-                    //                 }
-                    //             }
+            /**
+             * \brief Same as vector_reduce(ShapeEnum<D,MultiIndex>**, complex_t const**, std::size_t),
+             * but takes precomputed maps from the union shape into the component's shapes.
+             *
+             * Since the maps only depend on the basis shapes, compute them once using
+             * shapes::shape_enum::subset_map() and reuse them as long as the shapes stay the same.
+             * Then gathering the coefficients is a single indexed pass over the union shape.
+             *
+             * \param[in] subset_maps
+             * For each component: ordinal of each node of the union shape within the component's shape
+             * or \e std::numeric_limits<std::size_t>::max() if the node is missing.
+             * \param[in] subset_coeffs The coefficients of each wavepacket component.
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             */
+            ResultArrayXN vector_reduce(std::vector< std::vector<std::size_t> > const& subset_maps,
+                                                   complex_t const ** subset_coeffs,
+                                                   Workspace& workspace) const
+            {
+                const std::size_t n_components = subset_maps.size();
 
-                    std::vector<std::size_t> seek(n_components);
-                    for (long j = 0; j < next_basis.rows(); j++) {
-                        for (std::size_t n = 0; n < n_components; n++) {
-                            ShapeSlice<D,MultiIndex> const& subset_slice = subset_enums[n]->slice(islice+1);
+                // gather coefficients into the union shape, missing nodes contribute zero
+                CMatrix<Eigen::Dynamic,Eigen::Dynamic> coefficients(n_components, enumeration_->n_entries());
 
-                            if (seek[n] < subset_slice.size() && subset_slice[seek[n]] == superset_slice[j]) {
-                                complex_t cj = subset_coeffs[n][subset_slice.offset() + seek[n]];
+                for (std::size_t n = 0; n < n_components; n++) {
+                    std::vector<std::size_t> const& map = subset_maps[n];
 
-                                psi[n] += next_basis.row(j)*cj;
+                    if (map.size() != enumeration_->n_entries())
+                        throw std::runtime_error("subset_maps[n].size() != shape.size()");
 
-                                seek[n]++;
-                            }
-                        }
+                    for (std::size_t i = 0; i < map.size(); i++) {
+                        coefficients(n, i) = (map[i] != std::numeric_limits<std::size_t>::max()) ? subset_coeffs[n][map[i]] : complex_t(0,0);
                     }
                 }
 
-                CArray<Eigen::Dynamic,N> result(n_components, npts_);
-                for (std::size_t n = 0; n < n_components; n++) {
-                    result.row(n) = psi[n]();
-                }
-
-                return result;
+                return batch_reduce(coefficients, true, workspace);
             }
 
             /**
@@ -399,47 +736,990 @@ namespace waveblocks {
              * Complex 2D-Array of shape \f$ (C \times N) \f$,
              * where \f$ N \f$ is the number of quadrature points.
              */
-            CArray<Eigen::Dynamic,N> vector_reduce(complex_t const ** coefficients, std::size_t n_components) const
+            ResultArrayXN vector_reduce(complex_t const ** coefficients, std::size_t n_components) const
             {
-                // use Kahan's algorithm to accumulate bases with O(1) numerical error instead of O(Sqrt(N))
-                std::vector< math::KahanSum< CArray<1,N> > > psi(n_components);
-
-                HaWpBasisVector<N> prev_basis(0,npts_);
-                HaWpBasisVector<N> curr_basis(0,npts_);
-                HaWpBasisVector<N> next_basis(1,npts_);
+                Workspace workspace;
+                return vector_reduce(coefficients, n_components, workspace);
+            }
 
-                next_basis = seed();
+            /**
+             * \brief Same as vector_reduce(complex_t const**, std::size_t),
+             * but keeps the slice buffers in \p workspace.
+             *
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             */
+            ResultArrayXN vector_reduce(complex_t const ** coefficients, std::size_t n_components,
+                                                   Workspace& workspace) const
+            {
+                CMatrix<Eigen::Dynamic,Eigen::Dynamic> coefficient_matrix(n_components, enumeration_->n_entries());
 
                 for (std::size_t n = 0; n < n_components; n++) {
-                    psi[n] = math::KahanSum< CArray<1,N> >( CArray<1,N>::Zero(1,npts_)); // zero initialize
-                    psi[n] += coefficients[n][0]*next_basis.row(0);
+                    coefficient_matrix.row(n) = Eigen::Map< const CMatrix<1,Eigen::Dynamic> >(coefficients[n], enumeration_->n_entries());
                 }
 
-                for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
-                    prev_basis = std::move(curr_basis);
-                    curr_basis = std::move(next_basis);
+                return batch_reduce(coefficient_matrix, true, workspace);
+            }
 
-                    next_basis = step(islice, prev_basis, curr_basis);
+            /**
+             * \brief Evaluates many wavepackets that share the Hagedorn parameter set and the basis shape.
+             *
+             * The contraction of each slice with the coefficients of all components is one
+             * matrix-matrix product \f$ (C \times S) \cdot (S \times N) \f$,
+             * where \f$ S \f$ is the number of nodes within the slice.
+             *
+             * \param[in] coefficients
+             * Complex matrix of shape \f$ (C \times |\mathfrak{K}|) \f$.
+             * Row \f$ n \f$ contains the coefficients of component \f$ n \f$.
+             * \param[in] compensated
+             * Accumulate the contributions of the slices with Kahan's algorithm.
+             * Within one slice, the contributions are summed up by the matrix product.
+             * \return
+             * Complex 2D-Array of shape \f$ (C \times N) \f$,
+             * where \f$ N \f$ is the number of quadrature points.
+             */
+            ResultArrayXN batch_reduce(const CMatrix<Eigen::Dynamic,Eigen::Dynamic>& coefficients,
+                                                  bool compensated = true) const
+            {
+                Workspace workspace;
+                return batch_reduce(coefficients, compensated, workspace);
+            }
+
+            /**
+             * \brief Same as batch_reduce(const CMatrix<Eigen::Dynamic,Eigen::Dynamic>&, bool),
+             * but keeps the slice buffers in \p workspace.
+             *
+             * If the number of quadrature points is not known at compile-time, the recursion runs
+             * in compile-time tiles (same as reduce()) and each tile is contracted on its own.
+             *
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             */
+            ResultArrayXN batch_reduce(const CMatrix<Eigen::Dynamic,Eigen::Dynamic>& coefficients,
+                                                  bool compensated,
+                                                  Workspace& workspace) const
+            {
+                if ((std::size_t)coefficients.cols() != enumeration_->n_entries())
+                    throw std::runtime_error("coefficients.cols() != shape.size()");
+
+                const long n_components = coefficients.rows();
+
+                // no copy if the coefficients already have the accumulation type
+                auto&& coeffs = coefficients.template cast<accum_type>();
+
+                if (N == Eigen::Dynamic)
+                    return batch_reduce_fixed_tiles_(coeffs, compensated, workspace);
+
+                ResultArrayXN result = ResultArrayXN::Zero(n_components, npts_);
+                ResultArrayXN slice_result(n_components, npts_);
+
+                // use Kahan's algorithm to accumulate slices with O(1) numerical error instead of O(Sqrt(N))
+                math::KahanSum< ResultArrayXN > psi( ResultArrayXN::Zero(n_components, npts_) );
+
+                visit([&](ShapeSlice<D,MultiIndex> const& slice, ConstBasisRef basis) {
+                    if (compensated) {
+                        slice_result.matrix().noalias() = coeffs.middleCols(slice.offset(), basis.rows()) * basis.matrix().template cast<accum_type>();
+                        psi += slice_result;
+                    }
+                    else {
+                        result.matrix().noalias() += coeffs.middleCols(slice.offset(), basis.rows()) * basis.matrix().template cast<accum_type>();
+                    }
+                }, workspace);
+
+                if (compensated)
+                    return psi();
+                else
+                    return result;
+            }
+
+            /**
+             * \brief Evaluates the wavepacket and its gradient in one pass of the recursion.
+             *
+             * The lowering operators yield the gradient of each basis function from
+             * its backward neighbours:
+             * \f[
+             * -i\varepsilon^2\nabla_x \phi_k =
+             * \left(p + P Q^{-1}(x-q)\right) \phi_k
+             * - i\sqrt{2}\varepsilon Q^{-T} \left(\sqrt{k_d}\,\phi_{k-e^d}\right)_{d=1}^{D}
+             * \f]
+             * Thus the gradient is obtained without extending the basis shape
+             * and without computing the coefficients of HaWpGradient.
+             * Only the sums \f$ \Phi \f$ and
+             * \f$ L_d = \sum_k c_k \sqrt{k_d}\,\phi_{k-e^d} \f$ are accumulated slice by slice.
+             *
+             * \param[in] coefficients Vector of wavepacket coefficients, length is \f$ |\mathfrak{K}| \f$.
+             * \return
+             * Complex 2D-Array of shape \f$ ((1+D) \times N) \f$.
+             * Row \f$ 0 \f$ contains \f$ \Phi \f$ (same as reduce()),
+             * row \f$ 1+d \f$ contains \f$ -i\varepsilon^2\partial_{x_d}\Phi \f$
+             * (same convention as HaWpGradient).
+             */
+            ResultArrayXN reduce_gradient(CoefficientsRef coefficients) const
+            {
+                Workspace workspace;
+                return reduce_gradient(coefficients, workspace);
+            }
+
+            /**
+             * \brief Same as reduce_gradient(CoefficientsRef), but keeps the slice buffers in \p workspace.
+             *
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             */
+            ResultArrayXN reduce_gradient(CoefficientsRef coefficients, Workspace& workspace) const
+            {
+                if ((std::size_t)coefficients.size() != enumeration_->n_entries())
+                    throw std::runtime_error("coefficients.size() != shape.size()");
+
+                workspace.reserve(max_slice_size_(), npts_);
+
+                // row 0: Phi, row 1+d: L_d
+                ResultArrayXN slice_result(1+D, npts_);
+
+                // use Kahan's algorithm to accumulate slices with O(1) numerical error instead of O(Sqrt(N))
+                math::KahanSum< ResultArrayXN > sums( ResultArrayXN::Zero(1+D, npts_) );
+
+                workspace.buffer(0).row(0) = seed();
+
+                slice_result.setZero();
+                slice_result.row(0) = workspace.buffer(0).row(0).template cast<accum_type>()*accum_type(coefficients[0]);
+                sums += slice_result;
+
+                for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
+                    auto next_basis = workspace_step_(islice, workspace);
+                    auto curr_basis = workspace.buffer(islice).topRows(enumeration_->slice(islice).size());
+
+                    auto & next_links = enumeration_->links(islice+1);
 
-                    ShapeSlice<D,MultiIndex> const& slice = enumeration_->slice(islice+1);
+                    std::size_t offset = enumeration_->slice(islice+1).offset();
 
+                    slice_result.setZero();
 
                     for (long j = 0; j < next_basis.rows(); j++) {
-                        for (std::size_t n = 0; n < n_components; n++) {
-                            complex_t cj = coefficients[n][slice.offset() + j];
+                        accum_type cj = accum_type(coefficients[offset + j]);
+
+                        slice_result.row(0) += next_basis.row(j).template cast<accum_type>()*cj;
 
-                            psi[n] += next_basis.row(j)*cj;
+                        for (dim_t d = 0; d < D; d++) {
+                            std::size_t curr_ordinal = next_links.backward[j*D + d];
+                            if (curr_ordinal != ShapeSliceLinks<D>::npos)
+                                slice_result.row(1+d) += curr_basis.row(curr_ordinal).template cast<accum_type>() * (cj*A(next_links.sqrt[j*D + d]));
                         }
                     }
-                }
 
-                CArray<Eigen::Dynamic,N> result(n_components, npts_);
-                for (std::size_t n = 0; n < n_components; n++) {
-                    result.row(n) = psi[n]();
+                    sums += slice_result;
                 }
 
+                RMatrix<D,1> const& p = parameters_->p();
+
+                // no copy if the sums already have type complex_t
+                auto&& sum = sums().template cast<complex_t>();
+
+                ResultArrayXN result(1+D, npts_);
+
+                result.row(0) = sums().row(0);
+                result.bottomRows(D) = ( ( P_Qinv_dx_().colwise() + p.template cast<complex_t>() ).array().rowwise() * sum.row(0)
+                                       + complex_t(0, -std::sqrt(2.0)*eps_) * ( Qinv_.transpose() * sum.bottomRows(D).matrix() ).array()
+                                       ).template cast<accum_type>();
+
                 return result;
             }
+
+            /**
+             * \brief Streams the basis slice by slice through a user-defined functor.
+             *
+             * The recursion runs in the ring buffers of a workspace, as in reduce().
+             * After each slice is computed, the functor is called as
+             * \code
+             * visitor(ShapeSlice<D,MultiIndex> const& slice, ConstBasisRef basis);
+             * \endcode
+             * where row \f$ j \f$ of \p basis holds the values of the basis function
+             * \f$ \phi_{k} \f$, \f$ k = \f$ <tt>slice[j]</tt>, at all quadrature points.
+             * Use <tt>slice.offset() + j</tt> to find the ordinal of \f$ k \f$ within the basis shape.
+             *
+             * Slices are visited in order, starting with the slice of the ground state.
+             * The block is overwritten two slices later, so the functor must not keep it.
+             * Thus custom contractions (projections, weighted Gram blocks, several
+             * operators at once) need only \f$ \mathcal{O}(\text{slice}) \f$ memory.
+             *
+             * \param[in] visitor Functor that is called once per slice.
+             */
+            template<class Visitor>
+            void visit(Visitor&& visitor) const
+            {
+                Workspace workspace;
+                visit(std::forward<Visitor>(visitor), workspace);
+            }
+
+            /**
+             * \brief Same as visit(Visitor&&), but keeps the slice buffers in \p workspace.
+             *
+             * \param[in] visitor Functor that is called once per slice.
+             * \param[in,out] workspace Slice buffers, grown if too small.
+             */
+            template<class Visitor>
+            void visit(Visitor&& visitor, Workspace& workspace) const
+            {
+                workspace.reserve(max_slice_size_(), npts_);
+
+                workspace.buffer(0).row(0) = seed();
+
+                visitor(enumeration_->slice(0), ConstBasisRef(workspace.buffer(0).topRows(1)));
+
+                for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
+                    auto next_basis = workspace_step_(islice, workspace);
+
+                    visitor(enumeration_->slice(islice+1), ConstBasisRef(next_basis));
+                }
+            }
+
+        private:
+            /**
+             * Basis values of one slice restricted to a tile of quadrature points.
+             */
+            typedef Eigen::Array<complex_type,Eigen::Dynamic,Eigen::Dynamic> TileBasis;
+            typedef Eigen::Ref< TileBasis, 0, Eigen::OuterStride<> > TileRef;
+            typedef Eigen::Ref< const TileBasis, 0, Eigen::OuterStride<> > ConstTileRef;
+
+            /**
+             * Width of the compile-time tiles used for dynamically sized grids.
+             */
+            static const int FixedTileWidth = Workspace::TileWidth;
+
+            /**
+             * Number of quadrature points per chunk in reduce().
+             * Fixed, such that the chunks do not depend on the number of threads.
+             */
+            static const long ReduceChunkWidth = 256;
+
+            /**
+             * Basis values of one slice restricted to a compile-time tile of quadrature points (split-complex).
+             */
+            typedef typename Workspace::TileBuffer FixedTileBasis;
+            typedef Eigen::Array<T,D,FixedTileWidth,Eigen::RowMajor> FixedTilePlaneDN;
+
+            /**
+             * \brief Serial version of step() restricted to a tile of quadrature points.
+             *
+             * \param[in] islice Ordinal of current slice.
+             * \param[in] prev_basis Basis values of the tile on previous slice.
+             * \param[in] curr_basis Basis values of the tile on current slice.
+             * \param[out] next_basis Basis values of the tile on next slice.
+             * \param[in] Qinv_dx Columns of \f$ Q^{-1} (x - q) \f$ that belong to the tile.
+             */
+            template<class Prev, class Curr, class Next, class Xi>
+            void step_kernel_(std::size_t islice,
+                              const Prev& prev_basis,
+                              const Curr& curr_basis,
+                              Next&& next_basis,
+                              const Xi& Qinv_dx) const
+            {
+                auto & curr_links = enumeration_->links(islice);
+                auto & next_links = enumeration_->links(islice+1);
+
+                for (long j = 0; j < next_basis.rows(); j++) {
+                    step_row_(curr_links, next_links, j, prev_basis, curr_basis, next_basis.row(j), Qinv_dx);
+                }
+            }
+
+            /**
+             * Number of backward neighbours that the recursion formula may have to combine.
+             * At least 4, such that combine_() can be instantiated for every unrolled count.
+             */
+            static const int MaxTerms = D > 4 ? D : 4;
+
+            typedef std::array<std::size_t, std::size_t(MaxTerms)> TermOrdinals;
+            typedef std::array<complex_type, std::size_t(MaxTerms)> TermFactors;
+
+            /**
+             * \brief Computes the basis values of node \p j within the next slice.
+             *
+             * The backward neighbours are gathered first. Missing neighbours (on the border of the shape)
+             * are left out, such that they never touch the basis values of another node.
+             * Then the recursion formula is a single expression that reads every operand once
+             * and writes the target row once. It is unrolled at compile-time for up to 4 neighbours (see combine_()).
+             *
+             * \param[in] curr_links Links of the current slice.
+             * \param[in] next_links Links of the next slice.
+             * \param[in] j Ordinal of the node within the next slice.
+             * \param[in] prev_basis Basis values on previous slice.
+             * \param[in] curr_basis Basis values on current slice.
+             * \param[out] next_row Row \p j of the basis values on next slice.
+             * \param[in] Qinv_dx Columns of \f$ Q^{-1} (x - q) \f$ that belong to the arguments.
+             */
+            template<class Prev, class Curr, class Row, class Xi>
+            void step_row_(ShapeSliceLinks<D> const& curr_links,
+                           ShapeSliceLinks<D> const& next_links,
+                           std::size_t j,
+                           const Prev& prev_basis,
+                           const Curr& curr_basis,
+                           Row&& next_row,
+                           const Xi& Qinv_dx) const
+            {
+                //valid precursor: first non-zero entry
+                const dim_t axis = next_links.axis[j];
+                const std::size_t curr_ordinal = next_links.backward[j*D + axis];
+
+                const T sqrt_k = T(next_links.sqrt[j*D + axis]);
+
+                auto curr_term = curr_basis.row(curr_ordinal) * Qinv_dx.row(axis).array() * T(std::sqrt(2.0)/eps_);
+
+                TermOrdinals prev_ordinals;
+                TermFactors factors;
+                const int n = prev_terms_(curr_links, curr_ordinal, axis, prev_ordinals, factors);
+
+                switch (n) {
+                    case 0:
+                        next_row = curr_term / sqrt_k;
+                        break;
+                    case 1:
+                        combine_(std::forward<Row>(next_row), curr_term, prev_basis, prev_ordinals, factors, sqrt_k, std::integral_constant<int,1>());
+                        break;
+                    case 2:
+                        combine_(std::forward<Row>(next_row), curr_term, prev_basis, prev_ordinals, factors, sqrt_k, std::integral_constant<int,2>());
+                        break;
+                    case 3:
+                        combine_(std::forward<Row>(next_row), curr_term, prev_basis, prev_ordinals, factors, sqrt_k, std::integral_constant<int,3>());
+                        break;
+                    case 4:
+                        combine_(std::forward<Row>(next_row), curr_term, prev_basis, prev_ordinals, factors, sqrt_k, std::integral_constant<int,4>());
+                        break;
+                    default:
+                        combine_(std::forward<Row>(next_row), curr_term, prev_basis, prev_ordinals, factors, n, sqrt_k);
+                        break;
+                }
+            }
+
+            /**
+             * \brief Gathers the backward neighbours of node \p curr_ordinal within the current slice.
+             *
+             * \param[out] prev_ordinals Ordinals of the neighbours within the previous slice.
+             * \param[out] factors Factors \f$ f_d \f$ of the neighbours in the recursion formula.
+             * \return Number of neighbours, the remaining entries are undefined.
+             */
+            int prev_terms_(ShapeSliceLinks<D> const& curr_links,
+                            std::size_t curr_ordinal,
+                            dim_t axis,
+                            TermOrdinals& prev_ordinals,
+                            TermFactors& factors) const
+            {
+                int n = 0;
+                for (dim_t d = 0; d < D; d++) {
+                    std::size_t prev_ordinal = curr_links.backward[curr_ordinal*D + d];
+                    if (prev_ordinal != ShapeSliceLinks<D>::npos) {
+                        prev_ordinals[n] = prev_ordinal;
+                        factors[n] = Qh_Qinvt_(axis,d) * T(curr_links.sqrt[curr_ordinal*D + d]);
+                        n++;
+                    }
+                }
+                return n;
+            }
+
+            /**
+             * \brief Evaluates the recursion formula
+             * \f$ \phi_{k+e^a} = \left(t - \sum_d f_d \phi_{k-e^d}\right) / \sqrt{k_a+1} \f$
+             * for one neighbour. The overloads for 2, 3 and 4 neighbours spell out the sum, thus
+             * Eigen fuses it into one loop over the quadrature points.
+             */
+            template<class Row, class Term, class Prev>
+            void combine_(Row&& next_row, const Term& curr_term, const Prev& prev_basis,
+                          TermOrdinals const& o, TermFactors const& f,
+                          T sqrt_k, std::integral_constant<int,1>) const
+            {
+                next_row = (curr_term - prev_basis.row(o[0])*f[0]) / sqrt_k;
+            }
+
+            template<class Row, class Term, class Prev>
+            void combine_(Row&& next_row, const Term& curr_term, const Prev& prev_basis,
+                          TermOrdinals const& o, TermFactors const& f,
+                          T sqrt_k, std::integral_constant<int,2>) const
+            {
+                next_row = (curr_term - (prev_basis.row(o[0])*f[0] + prev_basis.row(o[1])*f[1])) / sqrt_k;
+            }
+
+            template<class Row, class Term, class Prev>
+            void combine_(Row&& next_row, const Term& curr_term, const Prev& prev_basis,
+                          TermOrdinals const& o, TermFactors const& f,
+                          T sqrt_k, std::integral_constant<int,3>) const
+            {
+                next_row = (curr_term - (prev_basis.row(o[0])*f[0] + prev_basis.row(o[1])*f[1] +
+                                         prev_basis.row(o[2])*f[2])) / sqrt_k;
+            }
+
+            template<class Row, class Term, class Prev>
+            void combine_(Row&& next_row, const Term& curr_term, const Prev& prev_basis,
+                          TermOrdinals const& o, TermFactors const& f,
+                          T sqrt_k, std::integral_constant<int,4>) const
+            {
+                next_row = (curr_term - (prev_basis.row(o[0])*f[0] + prev_basis.row(o[1])*f[1] +
+                                         prev_basis.row(o[2])*f[2] + prev_basis.row(o[3])*f[3])) / sqrt_k;
+            }
+
+            /**
+             * \brief Same as above for \p n > 4 neighbours: the sum is accumulated within the target row.
+             */
+            template<class Row, class Term, class Prev>
+            void combine_(Row&& next_row, const Term& curr_term, const Prev& prev_basis,
+                          TermOrdinals const& o, TermFactors const& f,
+                          int n, T sqrt_k) const
+            {
+                next_row = prev_basis.row(o[0])*f[0];
+
+                for (int i = 1; i < n; i++)
+                    next_row += prev_basis.row(o[i])*f[i];
+
+                next_row = (curr_term - next_row) / sqrt_k;
+            }
+
+            /**
+             * \brief Serial version of step() restricted to the quadrature points
+             * \f$ [col, col + ncols) \f$, where \f$ ncols \f$ is the number of columns of the arguments.
+             */
+            void step_tile_(std::size_t islice,
+                            ConstTileRef prev_basis,
+                            ConstTileRef curr_basis,
+                            TileRef next_basis,
+                            long col) const
+            {
+                step_kernel_(islice, prev_basis, curr_basis, next_basis, Qinv_dx_.middleCols(col, next_basis.cols()));
+            }
+
+            /**
+             * \brief Serial version of step() on a compile-time tile in split-complex layout.
+             *
+             * Complex products are spelled out as real multiply-adds on the real and imaginary planes.
+             *
+             * \param[in] islice Ordinal of current slice.
+             * \param[in] prev_basis Basis values of the tile on previous slice.
+             * \param[in] curr_basis Basis values of the tile on current slice.
+             * \param[out] next_basis Basis values of the tile on next slice.
+             * \param[in] xi_real Real part of \f$ \frac{\sqrt{2}}{\varepsilon} Q^{-1} (x - q) \f$ on the tile.
+             * \param[in] xi_imag Imaginary part of the same.
+             */
+            template<class Prev, class Curr, class Next>
+            void step_split_tile_(std::size_t islice,
+                                  const Prev& prev_basis,
+                                  const Curr& curr_basis,
+                                  Next&& next_basis,
+                                  const FixedTilePlaneDN& xi_real,
+                                  const FixedTilePlaneDN& xi_imag) const
+            {
+                typedef Eigen::Array<T,1,FixedTileWidth> Plane;
+                const int W = FixedTileWidth;
+
+                auto & curr_links = enumeration_->links(islice);
+                auto & next_links = enumeration_->links(islice+1);
+
+                TermOrdinals prev_ordinals;
+                TermFactors factors;
+
+                for (long j = 0; j < next_basis.rows(); j++) {
+                    //valid precursor: first non-zero entry
+                    const dim_t axis = next_links.axis[j];
+                    const std::size_t curr_ordinal = next_links.backward[j*D + axis];
+
+                    // contribution of current slice: (a + ib) * (c + id)
+                    const Plane curr_real = curr_basis.row(curr_ordinal).template head<W>();
+                    const Plane curr_imag = curr_basis.row(curr_ordinal).template tail<W>();
+
+                    Plane next_real = curr_real * xi_real.row(axis) - curr_imag * xi_imag.row(axis);
+                    Plane next_imag = curr_real * xi_imag.row(axis) + curr_imag * xi_real.row(axis);
+
+                    // contribution of previous slice: the factors are complex scalars
+                    const int n = prev_terms_(curr_links, curr_ordinal, axis, prev_ordinals, factors);
+
+                    for (int i = 0; i < n; i++) {
+                        const T w_real = factors[i].real();
+                        const T w_imag = factors[i].imag();
+
+                        auto prev_real = prev_basis.row(prev_ordinals[i]).template head<W>();
+                        auto prev_imag = prev_basis.row(prev_ordinals[i]).template tail<W>();
+
+                        next_real -= prev_real * w_real - prev_imag * w_imag;
+                        next_imag -= prev_real * w_imag + prev_imag * w_real;
+                    }
+
+                    const T sqrt_k = T(next_links.sqrt[j*D + axis]);
+
+                    next_basis.row(j).template head<W>() = next_real / sqrt_k;
+                    next_basis.row(j).template tail<W>() = next_imag / sqrt_k;
+                }
+            }
+
+            /**
+             * \brief Runs the recursion on compile-time tiles of FixedTileWidth quadrature points.
+             *
+             * Used by all(), reduce() and batch_reduce() if the number of quadrature points is not known at compile-time.
+             * The tiles are kept in split-complex layout (see HaWpEvaluatorWorkspace::TileBuffer).
+             * The last tile is padded with zero columns.
+             *
+             * \param[in] visit
+             * Called with (slice ordinal, first column, number of columns, tile basis values of slice)
+             * for slice 0 and every following slice.
+             * \param[in,out] workspace Holds the tile buffers of each thread, grown if too small.
+             */
+            template<class Visitor>
+            void fixed_tiles_(Visitor&& visit, Workspace& workspace) const
+            {
+                const long W = FixedTileWidth;
+                const long ntiles = (npts_ + W - 1) / W;
+
+                const CArray1N ground = seed();
+
+                int nthreads = 1;
+#ifdef _OPENMP
+                nthreads = omp_get_max_threads();
+#endif
+                workspace.reserve_tiles(nthreads, max_slice_size_());
+
+                #pragma omp parallel
+                {
+                    int thread = 0;
+#ifdef _OPENMP
+                    thread = omp_get_thread_num();
+#endif
+                    std::array< FixedTileBasis, 3 >& buffers = workspace.tiles(thread);
+
+                    FixedTilePlaneDN xi_real, xi_imag;
+
+                    #pragma omp for schedule(static)
+                    for (long itile = 0; itile < ntiles; itile++) {
+                        const long col = itile*W;
+                        const long ncols = std::min<long>(W, npts_ - col);
+
+                        xi_real.setZero();
+                        xi_imag.setZero();
+                        xi_real.leftCols(ncols) = Qinv_dx_.middleCols(col, ncols).real().array() * T(std::sqrt(2.0)/eps_);
+                        xi_imag.leftCols(ncols) = Qinv_dx_.middleCols(col, ncols).imag().array() * T(std::sqrt(2.0)/eps_);
+
+                        buffers[0].row(0).setZero();
+                        buffers[0].row(0).head(ncols) = ground.segment(col, ncols).real();
+                        buffers[0].row(0).segment(W, ncols) = ground.segment(col, ncols).imag();
+
+                        visit(-1, col, ncols, buffers[0].topRows(1));
+
+                        for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
+                            auto prev_basis = buffers[(islice+2)%3].topRows(enumeration_->slice(islice-1).size());
+                            auto curr_basis = buffers[islice%3].topRows(enumeration_->slice(islice).size());
+                            auto next_basis = buffers[(islice+1)%3].topRows(enumeration_->slice(islice+1).size());
+
+                            step_split_tile_(islice, prev_basis, curr_basis, next_basis, xi_real, xi_imag);
+
+                            visit(islice, col, ncols, next_basis);
+                        }
+                    }
+                }
+            }
+
+            /**
+             * \brief all() for dynamically sized grids.
+             */
+            BasisVector all_fixed_tiles_() const
+            {
+                BasisVector complete_basis(enumeration_->n_entries(), npts_);
+
+                Workspace workspace;
+                fixed_tiles_([&](int islice, long col, long ncols, typename FixedTileBasis::RowsBlockXpr next_basis) {
+                    auto block = complete_basis.block(enumeration_->slice(islice+1).offset(), col, next_basis.rows(), ncols);
+                    block.real() = next_basis.leftCols(ncols);
+                    block.imag() = next_basis.middleCols(FixedTileWidth, ncols);
+                }, workspace);
+
+                return complete_basis;
+            }
+
+            /**
+             * \brief reduce() for dynamically sized grids.
+             */
+            ResultArray1N reduce_fixed_tiles_(CoefficientsRef coefficients, Workspace& workspace) const
+            {
+                const int W = FixedTileWidth;
+
+                // real parts followed by imaginary parts
+                typedef Eigen::Array<A,1,2*FixedTileWidth> TileRow;
+
+                ResultArray1N psi(1, npts_);
+
+                // use Kahan's algorithm to accumulate bases with O(1) numerical error instead of O(Sqrt(N))
+                // one sum per tile, since tiles are processed concurrently
+                // fixed-size summands need an aligned allocator (e.g. with AVX)
+                std::vector< math::KahanSum< TileRow >, Eigen::aligned_allocator< math::KahanSum< TileRow > > >
+                    sums((npts_ + FixedTileWidth - 1) / FixedTileWidth, math::KahanSum< TileRow >( TileRow::Zero() ));
+
+                fixed_tiles_([&](int islice, long col, long ncols, typename FixedTileBasis::RowsBlockXpr next_basis) {
+                    math::KahanSum< TileRow >& sum = sums[col / FixedTileWidth];
+
+                    std::size_t offset = enumeration_->slice(islice+1).offset();
+
+                    TileRow term;
+
+                    for (long j = 0; j < next_basis.rows(); j++) {
+                        const accum_type cj = accum_type(coefficients[offset + j]);
+
+                        auto basis_real = next_basis.row(j).template head<W>().template cast<A>();
+                        auto basis_imag = next_basis.row(j).template tail<W>().template cast<A>();
+
+                        term.template head<W>() = basis_real*cj.real() - basis_imag*cj.imag();
+                        term.template tail<W>() = basis_real*cj.imag() + basis_imag*cj.real();
+
+                        sum += term;
+                    }
+
+                    if (islice + 1 == enumeration_->n_slices()) {
+                        psi.segment(col, ncols).real() = sum().head(ncols);
+                        psi.segment(col, ncols).imag() = sum().segment(W, ncols);
+                    }
+                }, workspace);
+
+                return psi;
+            }
+
+            /**
+             * \brief batch_reduce() for dynamically sized grids.
+             *
+             * The real and imaginary part of the coefficients are multiplied with the split-complex tile separately,
+             * thus every slice costs two real matrix products instead of one complex matrix product.
+             *
+             * \param[in] coeffs Coefficients of shape \f$ (C \times |\mathfrak{K}|) \f$ in the accumulation type.
+             */
+            template<class Coeffs>
+            ResultArrayXN batch_reduce_fixed_tiles_(const Coeffs& coeffs, bool compensated, Workspace& workspace) const
+            {
+                const int W = FixedTileWidth;
+
+                // real parts followed by imaginary parts
+                typedef Eigen::Array<A,Eigen::Dynamic,2*FixedTileWidth> TileResult;
+
+                const long n_components = coeffs.rows();
+                const long ntiles = (npts_ + FixedTileWidth - 1) / FixedTileWidth;
+
+                const Eigen::Matrix<A,Eigen::Dynamic,Eigen::Dynamic> coeffs_real = coeffs.real();
+                const Eigen::Matrix<A,Eigen::Dynamic,Eigen::Dynamic> coeffs_imag = coeffs.imag();
+
+                ResultArrayXN psi(n_components, npts_);
+
+                // products of the real respectively imaginary part of the coefficients with both planes of a tile
+                // one pair per tile, since tiles are processed concurrently
+                std::vector< TileResult > products_real(ntiles, TileResult::Zero(n_components, 2*W));
+                std::vector< TileResult > products_imag(ntiles, TileResult::Zero(n_components, 2*W));
+
+                // use Kahan's algorithm to accumulate slices with O(1) numerical error instead of O(Sqrt(N))
+                std::vector< math::KahanSum< TileResult > > sums;
+                if (compensated)
+                    sums.assign(ntiles, math::KahanSum< TileResult >( TileResult::Zero(n_components, 2*W) ));
+
+                fixed_tiles_([&](int islice, long col, long ncols, typename FixedTileBasis::RowsBlockXpr next_basis) {
+                    const long itile = col / FixedTileWidth;
+
+                    TileResult& product_real = products_real[itile];
+                    TileResult& product_imag = products_imag[itile];
+
+                    const std::size_t offset = enumeration_->slice(islice+1).offset();
+                    auto block_real = coeffs_real.middleCols(offset, next_basis.rows());
+                    auto block_imag = coeffs_imag.middleCols(offset, next_basis.rows());
+
+                    if (compensated) {
+                        product_real.matrix().noalias() = block_real * next_basis.matrix().template cast<A>();
+                        product_imag.matrix().noalias() = block_imag * next_basis.matrix().template cast<A>();
+
+                        // (a + ib) * (c + id): product_real becomes the complex product of the slice
+                        product_real.leftCols(W) -= product_imag.rightCols(W);
+                        product_real.rightCols(W) += product_imag.leftCols(W);
+
+                        sums[itile] += product_real;
+                    }
+                    else {
+                        product_real.matrix().noalias() += block_real * next_basis.matrix().template cast<A>();
+                        product_imag.matrix().noalias() += block_imag * next_basis.matrix().template cast<A>();
+                    }
+
+                    if (islice + 1 == enumeration_->n_slices()) {
+                        if (compensated) {
+                            psi.middleCols(col, ncols).real() = sums[itile]().leftCols(ncols);
+                            psi.middleCols(col, ncols).imag() = sums[itile]().middleCols(W, ncols);
+                        }
+                        else {
+                            psi.middleCols(col, ncols).real() = product_real.leftCols(ncols) - product_imag.middleCols(W, ncols);
+                            psi.middleCols(col, ncols).imag() = product_real.middleCols(W, ncols) + product_imag.leftCols(ncols);
+                        }
+                    }
+                }, workspace);
+
+                return psi;
+            }
+
+            /**
+             * \brief Chooses the number of quadrature points per tile.
+             *
+             * The default keeps three slices of a tile within 256 KiB (a typical L2 cache size)
+             * and rounds to a multiple of 8 quadrature points.
+             */
+            long tile_size_(long tile_size) const
+            {
+                if (tile_size <= 0) {
+                    const long budget = 256*1024 / (3*sizeof(complex_type)*max_slice_size_());
+                    tile_size = std::max<long>(8, budget / 8 * 8);
+                }
+                return std::max<long>(1, std::min<long>(tile_size, npts_));
+            }
+
+            /**
+             * \brief Contracts the basis with the coefficients on chunks of \p chunk quadrature points.
+             *
+             * Each chunk runs the whole slice recursion on its own columns of the workspace buffers,
+             * thus there is a single parallel region without barriers between slices.
+             * Every point is summed up by one thread in slice order, thus the result
+             * does not depend on the number of threads.
+             */
+            ResultArray1N reduce_chunks_(CoefficientsRef coefficients, Workspace& workspace, long chunk) const
+            {
+                typedef Eigen::Array<accum_type,1,Eigen::Dynamic> ChunkRow;
+
+                workspace.reserve(max_slice_size_(), npts_);
+
+                ResultArray1N psi(1, npts_);
+
+                const CArray1N ground = seed();
+
+                const long nchunks = (npts_ + chunk - 1) / chunk;
+
+                #pragma omp parallel for schedule(static) if(nchunks > 1)
+                for (long ichunk = 0; ichunk < nchunks; ichunk++) {
+                    const long col = ichunk*chunk;
+                    const long ncols = std::min<long>(chunk, npts_ - col);
+
+                    auto ground_basis = workspace.buffer(0).block(0, col, 1, ncols);
+                    ground_basis = ground.segment(col, ncols);
+
+                    // use Kahan's algorithm to accumulate bases with O(1) numerical error instead of O(Sqrt(N))
+                    math::KahanSum< ChunkRow > sum( ChunkRow::Zero(1,ncols) );
+
+                    sum += ground_basis.template cast<accum_type>()*accum_type(coefficients[0]);
+
+                    for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
+                        auto prev_basis = workspace.buffer(islice-1).block(0, col, enumeration_->slice(islice-1).size(), ncols);
+                        auto curr_basis = workspace.buffer(islice).block(0, col, enumeration_->slice(islice).size(), ncols);
+                        auto next_basis = workspace.buffer(islice+1).block(0, col, enumeration_->slice(islice+1).size(), ncols);
+
+                        step_kernel_(islice, prev_basis, curr_basis, next_basis, Qinv_dx_.middleCols(col, ncols));
+
+                        std::size_t offset = enumeration_->slice(islice+1).offset();
+
+                        for (long j = 0; j < next_basis.rows(); j++) {
+                            sum += next_basis.row(j).template cast<accum_type>()*accum_type(coefficients[offset + j]);
+                        }
+                    }
+
+                    psi.segment(col, ncols) = sum();
+                }
+
+                return psi;
+            }
+
+            /**
+             * \brief Returns the block of \p basis that belongs to slice \p islice and the given quadrature points.
+             */
+            Eigen::Block< BasisVector > slice_block_(BasisVector& basis, int islice, long col, long ncols) const
+            {
+                auto & slice = enumeration_->slice(islice);
+                return basis.block(slice.offset(), col, slice.size(), ncols);
+            }
+
+            /**
+             * \brief Checks whether \f$ Q \f$ and \f$ P \f$ are diagonal and the basis shape is a full box.
+             */
+            bool is_separable_() const
+            {
+                CMatrix<D,D> const& Q = parameters_->Q();
+                CMatrix<D,D> const& P = parameters_->P();
+
+                for (dim_t i = 0; i < D; i++) {
+                    for (dim_t j = 0; j < D; j++) {
+                        if (i != j && (Q(i,j) != complex_t(0) || P(i,j) != complex_t(0)))
+                            return false;
+                    }
+                }
+
+                std::size_t box = 1;
+                for (dim_t d = 0; d < D; d++)
+                    box *= enumeration_->limit(d) + 1;
+
+                return box == enumeration_->n_entries();
+            }
+
+            /**
+             * \brief Evaluates the one-dimensional factors of a separable basis.
+             *
+             * \return
+             * For each axis \f$ d \f$: Complex 2D-Array of shape \f$ ((K_d+1) \times N) \f$.
+             * Row \f$ n \f$ contains \f$ \phi^{(d)}_n(x_d) \f$, such that
+             * \f$ \phi_k(x) = \prod_d \phi^{(d)}_{k_d}(x_d) \f$.
+             */
+            std::array< BasisVector, std::size_t(D) > separable_factors_() const
+            {
+                RMatrix<D,1> const& p = parameters_->p();
+                CMatrix<D,D> const& P = parameters_->P();
+
+                std::array< BasisVector, std::size_t(D) > factors;
+
+                for (dim_t d = 0; d < D; d++) {
+                    const int K = enumeration_->limit(d);
+
+                    BasisVector& phi = factors[d];
+                    phi.resize(K+1, npts_);
+
+                    CArray<1,N> dx(1, npts_);
+                    if (real_grid_)
+                        dx = rdx_.row(d).array().template cast<complex_t>();
+                    else
+                        dx = dx_.row(d).array();
+
+                    // ground state: P*Q^{-1} is diagonal, thus the exponent is a sum over all axes
+                    CArray<1,N> e = complex_t(0.0, 1.0)/(eps_*eps_) * (0.5*dx*P(d,d)*Qinv_(d,d)*dx + p(d,0)*dx);
+                    phi.row(0) = ( e.exp() / std::pow(math::pi<real_t>()*eps_*eps_, 0.25) ).template cast<complex_type>();
+
+                    CArray1N Qinv_dx = Qinv_dx_.row(d).array();
+
+                    // one-dimensional three-term recursion
+                    for (int n = 0; n < K; n++) {
+                        if (n == 0)
+                            phi.row(n+1) = phi.row(n) * Qinv_dx * T(std::sqrt(2.0)/eps_ / std::sqrt(real_t(n+1)));
+                        else
+                            phi.row(n+1) = (phi.row(n) * Qinv_dx * T(std::sqrt(2.0)/eps_) - phi.row(n-1) * Qh_Qinvt_(d,d) * T(std::sqrt(real_t(n)))) / T(std::sqrt(real_t(n+1)));
+                    }
+                }
+
+                return factors;
+            }
+
+            /**
+             * \brief all() for separable bases: every basis function is a product of one-dimensional factors.
+             */
+            BasisVector all_separable_() const
+            {
+                BasisVector complete_basis(enumeration_->n_entries(), npts_);
+
+                const auto factors = separable_factors_();
+
+                #pragma omp parallel for schedule(dynamic)
+                for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
+                    auto & slice = enumeration_->slice(islice);
+
+                    for (std::size_t j = 0; j < slice.size(); j++) {
+                        std::array<int,D> index = slice[j];
+
+                        auto phi = complete_basis.row(slice.offset() + j);
+
+                        phi = factors[0].row(index[0]);
+                        for (dim_t d = 1; d < D; d++)
+                            phi *= factors[d].row(index[d]);
+                    }
+                }
+
+                return complete_basis;
+            }
+
+            /**
+             * \brief reduce() for separable bases.
+             *
+             * The coefficients are arranged in a tensor of shape \f$ (K_0+1) \times \dots \times (K_{D-1}+1) \f$
+             * and contracted axis by axis with the one-dimensional factors. The contraction of the
+             * first axis is a matrix product, the remaining axes shrink the tensor geometrically.
+             */
+            ResultArray1N reduce_separable_(CoefficientsRef coefficients) const
+            {
+                const auto factors = separable_factors_();
+
+                std::array<long, std::size_t(D)> extent;
+                for (dim_t d = 0; d < D; d++)
+                    extent[d] = enumeration_->limit(d) + 1;
+
+                // arrange coefficients in a tensor (first axis varies fastest)
+                Eigen::Matrix<accum_type,Eigen::Dynamic,Eigen::Dynamic> tensor(extent[0], enumeration_->n_entries() / extent[0]);
+                for (int islice = 0; islice < enumeration_->n_slices(); islice++) {
+                    auto & slice = enumeration_->slice(islice);
+
+                    for (std::size_t j = 0; j < slice.size(); j++) {
+                        std::array<int,D> index = slice[j];
+
+                        long column = 0;
+                        for (dim_t d = D-1; d > 0; d--)
+                            column = column*extent[d] + index[d];
+
+                        tensor(index[0], column) = accum_type(coefficients[slice.offset() + j]);
+                    }
+                }
+
+                // contract first axis: (M x K_0) * (K_0 x N)
+                ResultArrayXN partial(tensor.cols(), npts_);
+                partial.matrix().noalias() = tensor.transpose() * factors[0].matrix().template cast<accum_type>();
+
+                // contract remaining axes
+                for (dim_t d = 1; d < D; d++) {
+                    const long rows = partial.rows() / extent[d];
+
+                    ResultArrayXN next = ResultArrayXN::Zero(rows, npts_);
+                    for (long m = 0; m < rows; m++) {
+                        for (long k = 0; k < extent[d]; k++)
+                            next.row(m) += partial.row(m*extent[d] + k) * factors[d].row(k).template cast<accum_type>();
+                    }
+
+                    partial = std::move(next);
+                }
+
+                return partial.row(0);
+            }
+
+            /**
+             * \brief Computes \f$ P Q^{-1} (x - q) \f$ in real_t.
+             */
+            CMatrixDN P_Qinv_dx_() const
+            {
+                CMatrixDD P_Qinv = parameters_->P()*Qinv_;
+
+                if (real_grid_) {
+                    CMatrixDN P_Qinv_dx(D, npts_);
+                    P_Qinv_dx.real() = P_Qinv.real()*rdx_;
+                    P_Qinv_dx.imag() = P_Qinv.imag()*rdx_;
+                    return P_Qinv_dx;
+                }
+                else {
+                    return P_Qinv*dx_;
+                }
+            }
+
+            /**
+             * \brief Returns the number of nodes of the largest slice.
+             */
+            std::size_t max_slice_size_() const
+            {
+                std::size_t size = 1; // ground state
+                for (int islice = 0; islice < enumeration_->n_slices(); islice++)
+                    size = std::max(size, enumeration_->slice(islice).size());
+                return size;
+            }
+
+            /**
+             * \brief Returns the rows of \p basis that belong to slice \p islice.
+             */
+            typename BasisVector::RowsBlockXpr slice_rows_(BasisVector& basis, int islice) const
+            {
+                auto & slice = enumeration_->slice(islice);
+                return basis.middleRows(slice.offset(), slice.size());
+            }
+
+            /**
+             * \brief Computes the next slice within the ring buffers of \p workspace.
+             *
+             * \return Rows of the ring buffer that hold the next slice.
+             */
+            typename BasisVector::RowsBlockXpr workspace_step_(int islice, Workspace& workspace) const
+            {
+                auto prev_basis = workspace.buffer(islice-1).topRows(enumeration_->slice(islice-1).size());
+                auto curr_basis = workspace.buffer(islice).topRows(enumeration_->slice(islice).size());
+                auto next_basis = workspace.buffer(islice+1).topRows(enumeration_->slice(islice+1).size());
+
+                step(islice, prev_basis, curr_basis, next_basis);
+
+                return next_basis;
+            }
         };
     }
 }
@@ -1,15 +1,20 @@
 #pragma once
 
 #include <array>
+#include <vector>
+#include <limits>
 
 #include <Eigen/Core>
 
 #include "hawp_paramset.hpp"
 #include "shapes/shape_enum.hpp"
+#include "shapes/shape_enum_subset.hpp"
 
 
 namespace waveblocks {
     namespace wavepackets {
+        using shapes::ShapeSliceLinks;
+
         /**
          * \brief This class constructs the coefficients of the
          * Hagedorn gradient wavepacket \f$ -i\varepsilon^2\nabla_x \f$
@@ -61,55 +66,67 @@ namespace waveblocks {
                     grad_coeffs[d] = Coefficients(grad_enum_->n_entries());
                 }
 
+                const std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+                // positions of extended nodes within the basic shape (npos if missing)
+                std::vector<std::size_t> prev_map;
+                std::vector<std::size_t> curr_map = shapes::shape_enum::subset_ordinals(grad_enum_->slice(0), base_enum_->slice(0));
+                std::vector<std::size_t> next_map;
+
+                // forward neighbours within the extended shape
+                std::vector<std::size_t> forward;
+
                 //iterate over each slice [i = index of current slice]
                 for (int i = 0; i < grad_enum_->n_slices(); i++) {
+                    auto & curr_slice = grad_enum_->slice(i);
+
+                    auto & curr_links = grad_enum_->links(i);
+                    auto & next_links = grad_enum_->links(i+1);
+
+                    next_map = shapes::shape_enum::subset_ordinals(grad_enum_->slice(i+1), base_enum_->slice(i+1));
+
+                    // invert backward links of next slice
+                    forward.assign(curr_slice.size()*D, npos);
+                    for (std::size_t m = 0; m < grad_enum_->slice(i+1).size(); m++) {
+                        for (dim_t d = 0; d < D; d++) {
+                            if (next_links.backward[m*D+d] != ShapeSliceLinks<D>::npos)
+                                forward[next_links.backward[m*D+d]*D + d] = m;
+                        }
+                    }
+
+                    const std::size_t prev_offset = base_enum_->slice(i-1).offset();
+                    const std::size_t curr_offset = base_enum_->slice(i).offset();
+                    const std::size_t next_offset = base_enum_->slice(i+1).offset();
+
                     //loop over all multi-indices within current slice [j = position of multi-index within current slice]
                     #pragma omp parallel for
-                    for (std::size_t j = 0; j < grad_enum_->slice(i).size(); j++) {
-                        MultiIndex curr_index = grad_enum_->slice(i)[j];
-
+                    for (std::size_t j = 0; j < curr_slice.size(); j++) {
                         //central node
                         complex_t cc(0,0);
-                        std::size_t curr_ordinal = 0;
-                        bool central_node_exists = false;
-
-                        if ( (central_node_exists = base_enum_->slice(i).try_find(curr_index, curr_ordinal)) ) {
-
-                            curr_ordinal += base_enum_->slice(i).offset();
+                        bool central_node_exists = (curr_map[j] != npos);
 
-                            cc = base_coeffs[curr_ordinal];
+                        if (central_node_exists) {
+                            cc = base_coeffs[curr_offset + curr_map[j]];
                         }
 
                         //backward neighbours
-                        Eigen::Matrix<complex_t,D,1> cb;
+                        Eigen::Matrix<complex_t,D,1> cb = Eigen::Matrix<complex_t,D,1>::Zero();
                         for (dim_t d = 0; d < D; d++) {
-                            if (curr_index[d] != 0) {
-                                MultiIndex prev_index = curr_index; prev_index[d] -= 1;
-
-                                std::size_t prev_ordinal = 0;
-
-                                if (base_enum_->slice(i-1).try_find(prev_index, prev_ordinal)) {
-
-                                    prev_ordinal += base_enum_->slice(i-1).offset();
+                            std::size_t prev_ordinal = curr_links.backward[j*D+d];
 
-                                    cb[d] = base_coeffs[prev_ordinal] * std::sqrt(real_t(curr_index[d]));
-                                }
+                            if (prev_ordinal != ShapeSliceLinks<D>::npos && prev_map[prev_ordinal] != npos) {
+                                cb[d] = base_coeffs[prev_offset + prev_map[prev_ordinal]] * curr_links.sqrt[j*D+d];
                             }
                         }
 
                         //forward neighbours
-                        Eigen::Matrix<complex_t,D,1> cf;
-                        if (central_node_exists && i+1 < base_enum_->n_slices()) {
+                        Eigen::Matrix<complex_t,D,1> cf = Eigen::Matrix<complex_t,D,1>::Zero();
+                        if (central_node_exists) {
                             for (dim_t d = 0; d < D; d++) {
-                                MultiIndex next_index = curr_index; next_index[d] += 1;
-
-                                std::size_t next_ordinal = 0;
-
-                                if (base_enum_->slice(i+1).try_find(next_index, next_ordinal)) {
+                                std::size_t next_ordinal = forward[j*D+d];
 
-                                    next_ordinal += base_enum_->slice(i+1).offset();
-
-                                    cf[d] = base_coeffs[next_ordinal] * std::sqrt(real_t(curr_index[d]+1));
+                                if (next_ordinal != npos && next_map[next_ordinal] != npos) {
+                                    cf[d] = base_coeffs[next_offset + next_map[next_ordinal]] * next_links.sqrt[next_ordinal*D+d];
                                 }
                             }
                         }
@@ -121,9 +138,12 @@ namespace waveblocks {
                         Eigen::Matrix<complex_t,D,1> bgrad = (Pcf + Pcb)*eps_/std::sqrt(real_t(2)) + Pcc;
 
                         for (dim_t d = 0; d < D; d++) {
-                            grad_coeffs[d][grad_enum_->slice(i).offset() + j] = bgrad(d,0);
+                            grad_coeffs[d][curr_slice.offset() + j] = bgrad(d,0);
                         }
                     }
+
+                    prev_map.swap(curr_map);
+                    curr_map.swap(next_map);
                 }
 
                 return grad_coeffs;
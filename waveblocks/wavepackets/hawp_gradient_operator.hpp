@@ -204,24 +204,12 @@ namespace waveblocks {
              *
              * \tparam N
              * Number of quadrature points.
-             * Don't use Eigen::Dynamic. It works, but performance is bad.
+             * Eigen::Dynamic is evaluated in compile-time tiles (see HaWpEvaluator).
              */
             template<int N>
             CArray<Eigen::Dynamic,N> evaluate(CMatrix<D,N> const& grid) const
             {
-                ScalarHaWp<D,MultiIndex> scalarwp;
-
-                scalarwp.eps() = eps();
-                scalarwp.parameters() = parameters();
-                scalarwp.shape() = shape();
-
-                std::vector< complex_t const* > coeffs_list(n_components());
-
-                for (std::size_t n = 0; n < n_components(); n++) {
-                    coeffs_list[n] = component(n).coefficients().data();
-                }
-
-                return scalarwp.template create_evaluator<N>(grid).vector_reduce(coeffs_list.data(), n_components());
+                return evaluate_<N>(grid);
             }
 
             /**
@@ -239,16 +227,36 @@ namespace waveblocks {
              *
              * \tparam N
              * Number of quadrature points.
-             * Don't use Eigen::Dynamic. It works, but performance is bad.
+             * Eigen::Dynamic is evaluated in compile-time tiles (see HaWpEvaluator).
              */
             template<int N>
             CArray<Eigen::Dynamic,N> evaluate(RMatrix<D,N> const& rgrid) const
             {
-                CMatrix<D,N> cgrid = rgrid.template cast<complex_t>();
-                return evaluate(cgrid);
+                return evaluate_<N>(rgrid);
             }
 
         private:
+            /**
+             * \brief Implements evaluate() for complex and real grids.
+             */
+            template<int N, class Grid>
+            CArray<Eigen::Dynamic,N> evaluate_(Grid const& grid) const
+            {
+                ScalarHaWp<D,MultiIndex> scalarwp;
+
+                scalarwp.eps() = eps();
+                scalarwp.parameters() = parameters();
+                scalarwp.shape() = shape();
+
+                std::vector< complex_t const* > coeffs_list(n_components());
+
+                for (std::size_t n = 0; n < n_components(); n++) {
+                    coeffs_list[n] = component(n).coefficients().data();
+                }
+
+                return scalarwp.template create_evaluator<N>(grid).vector_reduce(coeffs_list.data(), n_components());
+            }
+
             real_t eps_;
             HaWpParamSet<D> parameters_;
             shapes::ShapeEnumSharedPtr<D,MultiIndex> shape_;
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "../types.hpp"
+
+#include "hawp_commons.hpp"
+#include "shapes/shape_enum.hpp"
+#include "shapes/shape_enum_extended.hpp"
+#include "shapes/shape_enum_subset.hpp"
+#include "shapes/shape_registry.hpp"
+
+
+namespace waveblocks {
+    namespace wavepackets {
+        /**
+         * \brief Adapts the basis shape of a wavepacket to its coefficients.
+         *
+         * The cost of a step with the non-quadratic remainder \f$ W \f$ grows with \f$ |\mathfrak{K}|^3 \f$
+         * (matrix exponential of \f$ F \f$), therefore it pays to keep the basis shape as small as the
+         * coefficients permit. adapt() does two things:
+         *  - _Prune:_ Drops every node \f$ \underline{k} \f$ with \f$ |c_{\underline{k}}| < \f$ prune_tolerance
+         *    \f$ \cdot \|c\| \f$, unless a kept node depends on it.
+         *  - _Grow:_ If the boundary nodes (nodes with a forward neighbour outside the shape) carry more than
+         *    grow_tolerance \f$ \cdot \|c\|^2 \f$ of the squared norm, the forward neighbours of the
+         *    non-negligible boundary nodes are added with zero coefficients.
+         *
+         * Both operations keep the shape closed under backward neighbours
+         * \f$ \underline{k} \in \mathfrak{K} \Rightarrow \underline{k}-\underline{e}^d \in \mathfrak{K} \f$,
+         * which the recursive evaluation requires. New nodes are taken from shape_enum::extend(),
+         * since every node of the grown shape is a node of the extension.
+         *
+         * Both criteria are checked on the current shape first (using its cached neighbour links),
+         * the extension is only enumerated if the shape is going to change.
+         * The new coefficient vector is filled in a single pass over the extension, copying only
+         * the kept coefficients. If nothing changes, the packet is not touched at all.
+         * Adapted shapes are interned in the ShapeRegistry, thus components that end up with
+         * the same shape share it.
+         *
+         * Install it as hook after every time step (see propagators::Propagator::afterStep()):
+         * \code{.cpp}
+         * HaWpShapeAdapter<D,MultiIndex> adapter(1e-8, 1e-10);
+         * propagator.afterStep([&](ScalarHaWp<D,MultiIndex>& packet) { adapter.adapt(packet); });
+         * \endcode
+         *
+         * Packets with a compile-time number of coefficients (StaticScalarHaWp) cannot be adapted.
+         *
+         * \tparam D The basis shape dimensionality.
+         * \tparam MultiIndex The type to represent a multi-index.
+         */
+        template<dim_t D, class MultiIndex>
+        class HaWpShapeAdapter
+        {
+        public:
+            typedef shapes::ShapeEnumSharedPtr<D,MultiIndex> ShapePointer;
+
+            /**
+             * \brief Coefficients below this fraction of the norm are negligible.
+             */
+            real_t prune_tolerance;
+
+            /**
+             * \brief The shape grows, if its boundary nodes carry more than this fraction of the squared norm.
+             */
+            real_t grow_tolerance;
+
+            /**
+             * \brief The shape does not grow beyond this number of nodes (0: no limit).
+             */
+            std::size_t max_entries;
+
+            HaWpShapeAdapter(real_t prune_tolerance, real_t grow_tolerance, std::size_t max_entries = 0)
+                : prune_tolerance(prune_tolerance)
+                , grow_tolerance(grow_tolerance)
+                , max_entries(max_entries)
+            { }
+
+            /**
+             * \brief Adapts a basis shape and remaps the coefficients accordingly.
+             *
+             * \param[in,out] shape Basis shape, replaced by a new enumeration if it changes.
+             * \param[in,out] coefficients Coefficients in the order of \p shape.
+             * \return Whether the shape has changed.
+             */
+            bool adapt(ShapePointer& shape, Coefficients& coefficients) const
+            {
+                typedef shapes::ShapeSliceLinks<D> Links;
+
+                const shapes::ShapeEnum<D,MultiIndex>& source = *shape;
+                if ((std::size_t)coefficients.size() != source.n_entries())
+                    throw std::runtime_error("shape.size != coefficients.size");
+
+                const real_t norm2 = coefficients.squaredNorm();
+                const real_t threshold = prune_tolerance*prune_tolerance*norm2;
+
+                // check both criteria on the source first, the extension is only built if the shape changes
+                bool prune = false;
+                for (std::size_t i = 1; i < source.n_entries() && !prune; i++)
+                    prune = std::norm(coefficients[i]) < threshold;
+
+                // boundary nodes: nodes with less than D forward neighbours, counted by the links of the next slice
+                std::vector<int> n_forward(source.n_entries(), 0);
+                for (int islice = 1; islice < source.n_slices(); islice++) {
+                    const Links& links = source.links(islice);
+                    const std::size_t prev_offset = source.slice(islice-1).offset();
+                    for (std::size_t j = 0; j < links.size(); j++) {
+                        for (dim_t d = 0; d < D; d++) {
+                            if (links.backward[j*D + d] != Links::npos)
+                                n_forward[prev_offset + links.backward[j*D + d]]++;
+                        }
+                    }
+                }
+
+                real_t boundary_norm2 = 0;
+                for (std::size_t i = 0; i < source.n_entries(); i++) {
+                    if (n_forward[i] < D)
+                        boundary_norm2 += std::norm(coefficients[i]);
+                }
+
+                const bool grow = boundary_norm2 > grow_tolerance*norm2;
+
+                // without pruning, a shape at the size limit cannot grow either
+                if (!prune && !(grow && (max_entries == 0 || source.n_entries() < max_entries)))
+                    return false;
+
+                // every node of the adapted shape is a node of the extension
+                shapes::ShapeEnum<D,MultiIndex> extension = shapes::shape_enum::extend(&source);
+                const std::vector<std::size_t> ordinals = shapes::shape_enum::subset_map(&extension, &source);
+                const std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+                auto backward = [&](int islice, std::size_t j, dim_t d) -> std::size_t {
+                    typename Links::ordinal_type k = extension.links(islice).backward[j*D + d];
+                    return k == Links::npos ? npos : extension.slice(islice-1).offset() + k;
+                };
+
+                // nodes to keep: non-negligible nodes and new forward neighbours of non-negligible boundary nodes
+                std::vector<char> keep(extension.n_entries(), 0);
+                for (int islice = 0; islice < extension.n_slices(); islice++) {
+                    const auto& slice = extension.slice(islice);
+                    for (std::size_t j = 0; j < slice.size(); j++) {
+                        std::size_t i = ordinals[slice.offset() + j];
+                        if (i != npos) {
+                            keep[slice.offset() + j] = (islice == 0 || std::norm(coefficients[i]) >= threshold);
+                            continue;
+                        }
+                        for (dim_t d = 0; grow && d < D; d++) {
+                            std::size_t k = backward(islice, j, d);
+                            if (k != npos && ordinals[k] != npos && std::norm(coefficients[ordinals[k]]) >= threshold)
+                                keep[slice.offset() + j] = 1;
+                        }
+                    }
+                }
+
+                // close under backward neighbours, slice by slice from the top
+                for (int islice = extension.n_slices() - 1; islice > 0; islice--) {
+                    const auto& slice = extension.slice(islice);
+                    for (std::size_t j = 0; j < slice.size(); j++) {
+                        if (!keep[slice.offset() + j])
+                            continue;
+                        for (dim_t d = 0; d < D; d++) {
+                            std::size_t k = backward(islice, j, d);
+                            if (k != npos)
+                                keep[k] = 1;
+                        }
+                    }
+                }
+
+                std::size_t n_kept = 0, n_added = 0;
+                for (std::size_t i = 0; i < extension.n_entries(); i++) {
+                    if (keep[i]) {
+                        n_kept++;
+                        n_added += (ordinals[i] == npos);
+                    }
+                }
+
+                // too large: prune only
+                if (n_added != 0 && max_entries != 0 && n_kept > max_entries) {
+                    for (std::size_t i = 0; i < extension.n_entries(); i++) {
+                        if (keep[i] && ordinals[i] == npos) {
+                            keep[i] = 0;
+                            n_kept--;
+                        }
+                    }
+                    n_added = 0;
+                }
+
+                if (n_added == 0 && n_kept == source.n_entries())
+                    return false;
+
+                std::vector< shapes::ShapeSlice<D,MultiIndex> > slices;
+                Coefficients adapted(n_kept);
+                MultiIndex limits{};
+                std::size_t offset = 0;
+
+                for (int islice = 0; islice < extension.n_slices(); islice++) {
+                    const auto& slice = extension.slice(islice);
+
+                    std::vector<MultiIndex> nodes;
+                    for (std::size_t j = 0; j < slice.size(); j++) {
+                        std::size_t i = slice.offset() + j;
+                        if (!keep[i])
+                            continue;
+
+                        adapted[offset + nodes.size()] = (ordinals[i] == npos) ? complex_t(0) : coefficients[ordinals[i]];
+                        nodes.push_back(slice[j]);
+                        for (dim_t d = 0; d < D; d++) {
+                            if (slice[j][d] > limits[d])
+                                limits[d] = slice[j][d];
+                        }
+                    }
+
+                    // a closed shape has no empty slice below a non-empty one
+                    if (nodes.empty())
+                        break;
+
+                    std::size_t size = nodes.size();
+                    slices.emplace_back(std::move(nodes), offset);
+                    offset += size;
+                }
+
+                shapes::ShapeEnum<D,MultiIndex> result(std::move(slices), offset, limits);
+                result.set_indexer();
+
+                shape = shapes::ShapeRegistry<D,MultiIndex>::instance().intern(std::move(result));
+                coefficients.swap(adapted);
+                return true;
+            }
+
+            /**
+             * \brief Adapts the basis shape of a scalar wavepacket.
+             *
+             * \return Whether the shape has changed.
+             */
+            bool adapt(ScalarHaWp<D,MultiIndex>& packet) const
+            {
+                return adapt(packet.shape(), packet.coefficients());
+            }
+
+            /**
+             * \brief Adapts the basis shapes of all components of a homogeneous wavepacket independently.
+             *
+             * \return Whether any shape has changed.
+             */
+            bool adapt(HomogeneousHaWp<D,MultiIndex>& packet) const
+            {
+                bool changed = false;
+                for (auto& component : packet.components())
+                    changed |= adapt(component.shape(), component.coefficients());
+                return changed;
+            }
+
+            /**
+             * \brief Adapts the basis shapes of all components of an inhomogeneous wavepacket independently.
+             *
+             * \return Whether any shape has changed.
+             */
+            bool adapt(InhomogeneousHaWp<D,MultiIndex>& packet) const
+            {
+                bool changed = false;
+                for (auto& component : packet.components())
+                    changed |= adapt(component.shape(), component.coefficients());
+                return changed;
+            }
+        };
+    }
+}
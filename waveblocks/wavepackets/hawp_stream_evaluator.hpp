@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <stdexcept>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include "hawp_commons.hpp"
+
+
+namespace waveblocks {
+    namespace wavepackets {
+        /**
+         * \brief Regular box grid whose points are generated on demand.
+         *
+         * The grid consists of the points
+         * \f$ x_i = o + (i_0 h_0, \dots, i_{D-1} h_{D-1}) \f$, \f$ 0 \leq i_d < n_d \f$.
+         * Points are numbered in row-major order (the last axis varies fastest),
+         * which is the memory layout of a \f$ n_0 \times \dots \times n_{D-1} \f$ HDF5 dataset or numpy array.
+         *
+         * \tparam D dimensionality of the grid
+         */
+        template<dim_t D>
+        class RegularGrid
+        {
+        public:
+            /**
+             * \param[in] origin Position of the first grid point \f$ o \f$.
+             * \param[in] spacing Distance between neighbouring grid points along each axis \f$ h \f$.
+             * \param[in] extents Number of grid points along each axis \f$ n \f$.
+             */
+            RegularGrid(RVector<D> const& origin,
+                        RVector<D> const& spacing,
+                        std::array<long, std::size_t(D)> const& extents)
+                : origin_(origin)
+                , spacing_(spacing)
+                , extents_(extents)
+            {
+                for (dim_t d = 0; d < D; d++) {
+                    if (extents_[d] <= 0)
+                        throw std::runtime_error("RegularGrid: extents must be positive");
+                }
+            }
+
+            /**
+             * \brief Number of grid points along each axis.
+             */
+            std::array<long, std::size_t(D)> const& extents() const
+            {
+                return extents_;
+            }
+
+            /**
+             * \brief Total number of grid points.
+             */
+            long size() const
+            {
+                long n = 1;
+                for (dim_t d = 0; d < D; d++)
+                    n *= extents_[d];
+                return n;
+            }
+
+            /**
+             * \brief Generates the grid points \f$ [first, first + count) \f$.
+             *
+             * \return Real matrix of shape \f$ (D \times count) \f$.
+             */
+            RMatrix<D,Eigen::Dynamic> points(long first, long count) const
+            {
+                RMatrix<D,Eigen::Dynamic> x(D, count);
+
+                // multi-index of first point
+                std::array<long, std::size_t(D)> index;
+                long rest = first;
+                for (dim_t d = D-1; d >= 0; d--) {
+                    index[d] = rest % extents_[d];
+                    rest /= extents_[d];
+                }
+
+                for (long j = 0; j < count; j++) {
+                    for (dim_t d = 0; d < D; d++)
+                        x(d,j) = origin_(d) + index[d]*spacing_(d);
+
+                    // increment multi-index, last axis fastest
+                    for (dim_t d = D-1; d >= 0; d--) {
+                        if (++index[d] < extents_[d])
+                            break;
+                        index[d] = 0;
+                    }
+                }
+
+                return x;
+            }
+
+        private:
+            RVector<D> origin_;
+            RVector<D> spacing_;
+            std::array<long, std::size_t(D)> extents_;
+        };
+
+        /**
+         * \brief Evaluates a wavepacket on a huge grid block by block with bounded memory.
+         *
+         * Neither the grid nor the result is held in memory. Each block of points is
+         * generated, evaluated (see HaWpEvaluator::reduce()) and passed to a sink, e.g.
+         * io::HDF5GridSink or io::BinaryGridSink, before the next block is generated.
+         * The blocks are evaluated in compile-time tiles, whose slice buffers are kept in one
+         * workspace and reused for all blocks. Per block, only the points, the ground state and
+         * the values of the block are allocated. Thus memory is bounded by
+         * \f$ \mathcal{O}(B + P \cdot \max_s |\mathfrak{K}_s|) \f$, where \f$ B \f$ is the block size
+         * and \f$ P \f$ the number of threads.
+         *
+         * A sink is any functor that is called once per block, in order:
+         * \code
+         * sink(long first, CArray<1,Eigen::Dynamic> const& values);
+         * \endcode
+         * where \p values holds the wavepacket on the grid points \f$ [first, first + values.size()) \f$.
+         *
+         * \tparam D dimensionality of wavepacket
+         * \tparam MultiIndex The type used to represent multi-indices.
+         */
+        template<dim_t D, class MultiIndex>
+        class HaWpStreamEvaluator
+        {
+        public:
+            /**
+             * \param[in] grid The grid to evaluate on.
+             * \param[in] block_size Number of grid points per block.
+             */
+            explicit HaWpStreamEvaluator(RegularGrid<D> const& grid, long block_size = 65536)
+                : grid_(grid)
+                , block_size_(block_size)
+            {
+                if (block_size_ <= 0)
+                    throw std::runtime_error("HaWpStreamEvaluator: block_size must be positive");
+            }
+
+            /**
+             * \brief Evaluates \f$ \Phi(x) \f$ on all grid points and streams the values into \p sink.
+             *
+             * Notice that this function does not include the prefactor
+             * \f$ \frac{1}{\sqrt{det(Q)}} \f$ nor the global phase
+             * \f$ \exp{(\frac{iS}{\varepsilon^2})} \f$ (same as AbstractScalarHaWp::evaluate()).
+             *
+             * \param[in] packet The wavepacket.
+             * \param[in] sink Functor that receives the values of each block.
+             */
+            template<class Sink>
+            void evaluate(AbstractScalarHaWp<D,MultiIndex> const& packet, Sink&& sink) const
+            {
+                if (packet.shape()->n_entries() != (std::size_t)packet.coefficients().size())
+                    throw std::runtime_error("shape.size() != coefficients.size()");
+
+                HaWpEvaluatorWorkspace<Eigen::Dynamic> workspace;
+
+                const long npts = grid_.size();
+
+                for (long first = 0; first < npts; first += block_size_) {
+                    const long count = std::min(block_size_, npts - first);
+
+                    RMatrix<D,Eigen::Dynamic> x = grid_.points(first, count);
+
+                    CArray<1,Eigen::Dynamic> values = packet.template create_evaluator<Eigen::Dynamic>(x).reduce(packet.coefficients(), workspace);
+
+                    sink(first, values);
+                }
+            }
+
+            /**
+             * \brief The grid to evaluate on.
+             */
+            RegularGrid<D> const& grid() const
+            {
+                return grid_;
+            }
+
+        private:
+            RegularGrid<D> grid_;
+            long block_size_;
+        };
+    }
+}
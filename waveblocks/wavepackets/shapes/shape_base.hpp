@@ -77,6 +77,26 @@ namespace waveblocks {
                  * \param out The output stream.
                  */
                 virtual void print(std::ostream & out) const = 0;
+
+                /**
+                 * \brief Writes a key that identifies the nodes of the shape.
+                 *
+                 * ShapeRegistry and the shape enumeration file cache (see yaml::ShapeDecoder) take two
+                 * shapes with equal keys to contain the same nodes without enumerating them.
+                 * Thus the key must name the shape class and cover _every_ parameter
+                 * that influences limit() and bbox(). Unlike print(), it is not meant for display.
+                 *
+                 * The default writes no key. Such shapes are always enumerated
+                 * and identified by their nodes.
+                 *
+                 * \param out The output stream.
+                 * \return Whether a key has been written.
+                 */
+                virtual bool identity(std::ostream & out) const
+                {
+                    (void)out;
+                    return false;
+                }
             };
 
             template<dim_t D>
@@ -1,6 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <functional>
 #include <stdexcept>
 
 #include "../../types.hpp"
@@ -9,6 +16,248 @@
 namespace waveblocks {
     namespace wavepackets {
         namespace shapes {
+            /**
+             * \brief Closed-form position of a node within its slice, valid if every slice is a complete slice of the bounding box.
+             *
+             * Some enumerations, notably of hypercubic shapes and of simplices \f$ \sum_d k_d \leq S \f$,
+             * contain all nodes of the bounding box \f$ 0 \leq k_d \leq K_d \f$ with \f$ \sum_d k_d = s \f$ in slice \f$ s \f$.
+             * Then the position of node \f$ \underline{k} \f$ within its lexically ordered slice is
+             *
+             * \f[
+             * \sum_{d=0}^{D-1} \sum_{v=0}^{k_d-1} C_{d+1}\left(s - k_0 - \ldots - k_{d-1} - v\right)
+             * \f]
+             *
+             * where \f$ C_d(r) \f$ counts the tuples \f$ (k_d, \ldots, k_{D-1}) \f$ of the bounding box with sum \f$ r \f$.
+             * Each inner sum is the difference of two precomputed prefix sums, thus a lookup
+             * costs \f$ \mathcal{O}(D) \f$ instead of a binary search over the slice.
+             *
+             * ShapeEnumerator installs an indexer into every enumeration it can be used for
+             * (see ShapeEnum::set_indexer()).
+             */
+            template<dim_t D>
+            class ShapeSliceIndexer
+            {
+            private:
+                std::array<int,D> limits_;
+
+                int max_sum_;
+
+                /**
+                 * Row \f$ d \f$ contains \f$ P_d(r) = \sum_{r' < r} C_d(r') \f$ for \f$ 0 \leq r \leq S+1 \f$.
+                 */
+                std::vector<std::size_t> prefix_;
+
+                std::size_t prefix_at_(dim_t d, int r) const
+                {
+                    return prefix_[d*(max_sum_+2) + r];
+                }
+
+            public:
+                /**
+                 * \param[in] limits Bounding box \f$ K \f$ (inclusive, see ShapeEnum::limits()).
+                 */
+                ShapeSliceIndexer(std::array<int,D> const& limits)
+                    : limits_(limits)
+                    , max_sum_(0)
+                {
+                    for (dim_t d = 0; d < D; d++)
+                        max_sum_ += limits_[d];
+
+                    const int width = max_sum_ + 2;
+
+                    prefix_.assign((D+1)*width, 0);
+
+                    // C_D(r) = 1 if r = 0 else 0
+                    for (int r = 1; r < width; r++)
+                        prefix_[D*width + r] = 1;
+
+                    for (dim_t d = D-1; d >= 0; d--) {
+                        for (int r = 0; r <= max_sum_; r++) {
+                            // C_d(r) = sum_{v=0}^{min(K_d,r)} C_{d+1}(r-v)
+                            std::size_t count = prefix_at_(d+1, r+1) - prefix_at_(d+1, std::max(r - limits_[d], 0));
+                            prefix_[d*width + r+1] = prefix_[d*width + r] + count;
+                        }
+                    }
+                }
+
+                /**
+                 * \brief Retrieves the number of nodes of the bounding box in slice \f$ s \f$.
+                 */
+                std::size_t count(int islice) const
+                {
+                    if (islice < 0 || islice > max_sum_)
+                        return 0;
+
+                    return prefix_at_(0, islice+1) - prefix_at_(0, islice);
+                }
+
+                /**
+                 * \brief Returns the position of a node within its slice.
+                 *
+                 * Portable programs should never call this function with a node outside
+                 * of the bounding box, since this causes _undefined behaviour_.
+                 */
+                template<class MultiIndex>
+                std::size_t position(const MultiIndex& index) const
+                {
+                    int rem = 0;
+                    for (dim_t d = 0; d < D; d++)
+                        rem += index[d];
+
+                    std::size_t pos = 0;
+                    for (dim_t d = 0; d < D-1; d++) {
+                        const int k = index[d];
+                        pos += prefix_at_(d+1, rem+1) - prefix_at_(d+1, rem-k+1);
+                        rem -= k;
+                    }
+                    return pos;
+                }
+
+                /**
+                 * \brief Retrieves the position of a node within slice \f$ s \f$, if the node is part of it.
+                 *
+                 * \param[in] index The node \f$ k \f$.
+                 * \param[in] islice The slice \f$ s \f$.
+                 * \param[out] ordinal Position of the node within slice \f$ s \f$.
+                 * \return Whether node \f$ k \f$ is part of slice \f$ s \f$.
+                 */
+                template<class MultiIndex>
+                bool try_find(const MultiIndex& index, int islice, std::size_t& ordinal) const
+                {
+                    int sum = 0;
+                    for (dim_t d = 0; d < D; d++) {
+                        if ((int)index[d] > limits_[d])
+                            return false;
+                        sum += index[d];
+                    }
+
+                    if (sum != islice)
+                        return false;
+
+                    ordinal = position(index);
+                    return true;
+                }
+            };
+
+            /**
+             * \brief Open-addressing hash table that maps the nodes of a slice to their positions.
+             *
+             * General shapes (e.g. HyperbolicCutShape in high dimensions) have slices with tens of thousands
+             * of nodes, where binary search costs many cache misses. This table stores each node together
+             * with its position in one flat array of slots, probed linearly. The load factor is at most 1/2,
+             * thus a lookup inspects about two adjacent slots.
+             *
+             * Nodes are hashed with std::hash<MultiIndex> (the packed integer of TinyMultiIndex),
+             * scrambled by Fibonacci hashing, since the low bits of a packed multi-index are poorly distributed.
+             *
+             * Use ShapeEnum::enable_hash_index() to build the tables of all slices.
+             */
+            template<class MultiIndex>
+            class ShapeSliceHashIndex
+            {
+            public:
+                typedef std::uint32_t ordinal_type;
+
+                /**
+                 * \brief Marks an empty slot.
+                 */
+                static const ordinal_type npos = std::numeric_limits<ordinal_type>::max();
+
+            private:
+                struct Slot
+                {
+                    MultiIndex key;
+                    ordinal_type ordinal;
+                };
+
+                std::vector<Slot> slots_;
+
+                std::size_t mask_ = 0;
+
+                int shift_ = 0;
+
+                std::size_t bucket_(const MultiIndex& index) const
+                {
+                    std::uint64_t hash = std::hash<MultiIndex>()(index);
+                    return std::size_t((hash * UINT64_C(0x9E3779B97F4A7C15)) >> shift_);
+                }
+
+            public:
+                ShapeSliceHashIndex() = default;
+
+                /**
+                 * \brief Builds the table of the nodes \f$ [begin, end) \f$.
+                 *
+                 * The position of a node is its distance to \p begin.
+                 */
+                template<class Iterator>
+                ShapeSliceHashIndex(Iterator begin, Iterator end)
+                {
+                    const std::size_t size = end - begin;
+
+                    if (size >= npos)
+                        throw std::runtime_error("slice is too large to build a hash index");
+
+                    // smallest power of two with load factor <= 1/2
+                    int bits = 1;
+                    while ((std::size_t(1) << bits) < 2*size)
+                        bits++;
+
+                    slots_.assign(std::size_t(1) << bits, Slot{MultiIndex{}, npos});
+                    mask_ = slots_.size() - 1;
+                    shift_ = 64 - bits;
+
+                    for (Iterator it = begin; it != end; ++it) {
+                        std::size_t pos = bucket_(*it);
+                        while (slots_[pos].ordinal != npos)
+                            pos = (pos + 1) & mask_;
+
+                        slots_[pos].key = *it;
+                        slots_[pos].ordinal = ordinal_type(it - begin);
+                    }
+                }
+
+                /**
+                 * \brief Checks whether the table has been built.
+                 */
+                bool empty() const
+                {
+                    return slots_.empty();
+                }
+
+                /**
+                 * \brief Retrieves the position of a node, if the node is part of the table.
+                 *
+                 * _Complexity:_ Constant on average.
+                 *
+                 * \param[in] index The node \f$ k \f$.
+                 * \param[out] ordinal Position of the node.
+                 * \return Whether node \f$ k \f$ is part of the table.
+                 */
+                bool try_find(const MultiIndex& index, std::size_t& ordinal) const
+                {
+                    std::equal_to< MultiIndex > equals;
+
+                    std::size_t pos = bucket_(index);
+                    while (true) {
+                        const Slot& slot = slots_[pos];
+
+                        if (slot.ordinal == npos)
+                            return false;
+
+                        if (equals(slot.key, index)) {
+                            ordinal = slot.ordinal;
+                            return true;
+                        }
+
+                        pos = (pos + 1) & mask_;
+                    }
+                }
+            };
+
+            template<class MultiIndex>
+            const typename ShapeSliceHashIndex<MultiIndex>::ordinal_type ShapeSliceHashIndex<MultiIndex>::npos;
+
             /**
              * \brief The \f$ s \f$-th slice of a shape enumeration contains all multi-indices
              * \f$ \boldsymbol{k} \in \mathfrak{K} \f$
@@ -22,8 +271,31 @@ namespace waveblocks {
 
                 std::vector< MultiIndex > table_;
 
+                /**
+                 * Keeps external node storage alive (e.g. a memory-mapped file) or null, if the slice owns its nodes.
+                 */
+                std::shared_ptr< const void > storage_;
+                const MultiIndex* view_ = nullptr;
+                std::size_t view_size_ = 0;
+
                 //     std::unordered_map< MultiIndex, std::size_t > dict_;
 
+                /**
+                 * Closed-form lookup of this slice (see ShapeEnum::set_indexer()) or null.
+                 */
+                std::shared_ptr< const ShapeSliceIndexer<D> > indexer_;
+                int islice_ = 0;
+
+                /**
+                 * Hash table of all nodes (see enable_hash_index()) or empty.
+                 */
+                ShapeSliceHashIndex<MultiIndex> hash_index_;
+
+                inline const MultiIndex* data_() const
+                {
+                    return storage_ ? view_ : table_.data();
+                }
+
                 inline MultiIndex forward_(MultiIndex index, dim_t axis) const
                 {
                     index[axis] += 1;
@@ -37,7 +309,7 @@ namespace waveblocks {
                 }
 
             public:
-                typedef typename std::vector<MultiIndex>::const_iterator const_iterator;
+                typedef const MultiIndex* const_iterator;
 
                 ShapeSlice() = default;
 
@@ -46,6 +318,12 @@ namespace waveblocks {
                 ShapeSlice(ShapeSlice&& that)
                     : offset_(that.offset_)
                     , table_(std::move(that.table_))
+                    , storage_(std::move(that.storage_))
+                    , view_(that.view_)
+                    , view_size_(that.view_size_)
+                    , indexer_(std::move(that.indexer_))
+                    , islice_(that.islice_)
+                    , hash_index_(std::move(that.hash_index_))
                 { }
 
                 ShapeSlice &operator=(const ShapeSlice & that) = default;
@@ -54,6 +332,12 @@ namespace waveblocks {
                 {
                     offset_ = that.offset_;
                     table_ = std::move(that.table_);
+                    storage_ = std::move(that.storage_);
+                    view_ = that.view_;
+                    view_size_ = that.view_size_;
+                    indexer_ = std::move(that.indexer_);
+                    islice_ = that.islice_;
+                    hash_index_ = std::move(that.hash_index_);
                     return *this;
                 }
 
@@ -67,14 +351,58 @@ namespace waveblocks {
                     , table_(std::move(table))
                 { }
 
+                /**
+                 * \brief Creates a slice that refers to external nodes instead of owning a copy.
+                 *
+                 * \param[in] storage Keeps the nodes alive as long as the slice (or a copy of it) exists.
+                 * \param[in] nodes Pointer to the first of \p size nodes in ascending order.
+                 * \param[in] size Number of nodes.
+                 * \param[in] offset Ordinal of the first node.
+                 */
+                ShapeSlice(std::shared_ptr< const void > storage, const MultiIndex* nodes, std::size_t size, std::size_t offset)
+                    : offset_(offset)
+                    , table_()
+                    , storage_(std::move(storage))
+                    , view_(nodes)
+                    , view_size_(size)
+                {
+                    if (!storage_)
+                        throw std::invalid_argument("ShapeSlice: external nodes need a storage owner");
+                }
+
+                /**
+                 * \brief Returns the nodes for modification.
+                 *
+                 * A slice that refers to external nodes copies them first.
+                 */
                 std::vector< MultiIndex > & _table()
                 {
+                    if (storage_) {
+                        table_.assign(view_, view_ + view_size_);
+                        storage_.reset();
+                        view_ = nullptr;
+                        view_size_ = 0;
+                    }
                     return table_;
                 }
 
-                std::vector< MultiIndex > const& _table() const
+                /**
+                 * \brief Checks whether the slice refers to external nodes, e.g. a memory-mapped file.
+                 */
+                bool mapped() const
+                {
+                    return bool(storage_);
+                }
+
+                /**
+                 * \brief Installs a closed-form lookup for this slice, which is slice \p islice of its enumeration.
+                 *
+                 * Use ShapeEnum::set_indexer() instead, which checks that the indexer is valid.
+                 */
+                void _set_indexer(std::shared_ptr< const ShapeSliceIndexer<D> > indexer, int islice)
                 {
-                    return table_;
+                    indexer_ = std::move(indexer);
+                    islice_ = islice;
                 }
 
                 /**
@@ -92,7 +420,34 @@ namespace waveblocks {
                  */
                 std::size_t size() const
                 {
-                    return table_.size();
+                    return storage_ ? view_size_ : table_.size();
+                }
+
+                /**
+                 * \brief Checks whether lookups use a closed-form indexer (see ShapeSliceIndexer).
+                 */
+                bool indexed() const
+                {
+                    return bool(indexer_);
+                }
+
+                /**
+                 * \brief Builds a hash table of all nodes, such that lookups take constant time (see ShapeSliceHashIndex).
+                 *
+                 * This is opt-in, since the table needs about twice the memory of the slice.
+                 * Modifying the nodes by _table() afterwards invalidates the table.
+                 */
+                void enable_hash_index()
+                {
+                    hash_index_ = ShapeSliceHashIndex<MultiIndex>(begin(), end());
+                }
+
+                /**
+                 * \brief Checks whether lookups use a hash table (see enable_hash_index()).
+                 */
+                bool hashed() const
+                {
+                    return !hash_index_.empty();
                 }
 
                 /**
@@ -100,7 +455,7 @@ namespace waveblocks {
                  */
                 const_iterator begin() const
                 {
-                    return table_.begin();
+                    return data_();
                 }
 
                 /**
@@ -108,7 +463,7 @@ namespace waveblocks {
                  */
                 const_iterator end() const
                 {
-                    return table_.end();
+                    return data_() + size();
                 }
 
                 /**
@@ -116,7 +471,7 @@ namespace waveblocks {
                  */
                 const_iterator cbegin() const
                 {
-                    return table_.cbegin();
+                    return begin();
                 }
 
                 /**
@@ -124,7 +479,7 @@ namespace waveblocks {
                  */
                 const_iterator cend() const
                 {
-                    return table_.cend();
+                    return end();
                 }
 
                 /**
@@ -144,7 +499,7 @@ namespace waveblocks {
                 {
                     assert(ordinal < size());
 
-                    return table_[ordinal];
+                    return data_()[ordinal];
                 }
 
                 /**
@@ -154,7 +509,9 @@ namespace waveblocks {
                  *
                  * _Caution:_ You have to add the slice-offset to the position to get the _ordinal_ of the node.
                  *
-                 * _Complexity:_ Logarithmic in the number of slice-nodes.
+                 * _Complexity:_ Logarithmic in the number of slice-nodes,
+                 * linear in the dimensionality if the enumeration has an indexer (see ShapeSliceIndexer),
+                 * constant on average if the slice has a hash table (see enable_hash_index()).
                  *
                  * \param[in] index The node \f$ k \f$.
                  * \param[out] ordinal Reference to
@@ -162,12 +519,18 @@ namespace waveblocks {
                  */
                 bool try_find(const MultiIndex& index, std::size_t& ordinal) const
                 {
+                    if (indexer_)
+                        return indexer_->try_find(index, islice_, ordinal);
+
+                    if (!hash_index_.empty())
+                        return hash_index_.try_find(index, ordinal);
+
                     std::less< MultiIndex > comp;
 
-                    auto it = std::lower_bound(table_.begin(), table_.end(), index, comp);
+                    auto it = std::lower_bound(begin(), end(), index, comp);
 
-                    if (it != table_.end() && *it == index) {
-                        ordinal = it - table_.begin();
+                    if (it != end() && *it == index) {
+                        ordinal = it - begin();
                         return true;
                     }
                     else {
@@ -185,7 +548,9 @@ namespace waveblocks {
                  *
                  * _Caution:_ You have to add the slice-offset to the position to get the _ordinal_ of the node.
                  *
-                 * _Complexity:_ Logarithmic in the number of slice-nodes.
+                 * _Complexity:_ Logarithmic in the number of slice-nodes,
+                 * linear in the dimensionality if the enumeration has an indexer (see ShapeSliceIndexer),
+                 * constant on average if the slice has a hash table (see enable_hash_index()).
                  *
                  * \param[in] index The
                  * \return The position of the specified node.
@@ -219,6 +584,22 @@ namespace waveblocks {
 
                     MultiIndex index(_index);
 
+                    if (indexer_) {
+                        for (dim_t d = 0; d < D; d++) {
+                            if (index[d] != 0)
+                                ordinals[d] = indexer_->position(backward_(index, d));
+                        }
+                        return ordinals;
+                    }
+
+                    if (!hash_index_.empty()) {
+                        for (dim_t d = 0; d < D; d++) {
+                            if (index[d] != 0)
+                                hash_index_.try_find(backward_(index, d), ordinals[d]);
+                        }
+                        return ordinals;
+                    }
+
                     std::less< MultiIndex > comp;
 
                     // find last non-zero entry
@@ -228,15 +609,15 @@ namespace waveblocks {
                     }
 
                     if (dlast >= 0) {
-                        auto lower = table_.begin();
+                        auto lower = begin();
 
-                        auto upper = std::lower_bound(lower, table_.end(), backward_(index, dlast), comp);
-                        ordinals[dlast] = upper - table_.begin();
+                        auto upper = std::lower_bound(lower, end(), backward_(index, dlast), comp);
+                        ordinals[dlast] = upper - begin();
 
                         for (dim_t i = 0; i < dlast; i++) {
                             if (index[i] != 0) {
                                 lower = std::lower_bound(lower, upper, backward_(index, i), comp);
-                                ordinals[i] = lower - table_.begin();
+                                ordinals[i] = lower - begin();
                             }
                         }
                     }
@@ -249,15 +630,67 @@ namespace waveblocks {
                  */
                 bool operator==(const ShapeSlice& that) const
                 {
-                    return table_ == that.table_;
+                    return size() == that.size() && std::equal(begin(), end(), that.begin());
                 }
 
                 bool operator!=(const ShapeSlice& that) const
                 {
-                    return table_ != that.table_;
+                    return !(*this == that);
                 }
             };
 
+            /**
+             * \brief Precomputed neighbour links of all nodes \f$ \underline{k} \f$ within one slice.
+             *
+             * The recursive evaluation of wavepackets needs, for every node, the ordinals of all
+             * backward neighbours \f$ \underline{k}-\underline{e}^d \f$ within the previous slice.
+             * Looking them up with ShapeSlice::find() costs a binary search per neighbour.
+             * This table stores the results of these searches in flat arrays.
+             *
+             * All per-axis entries of node \f$ j \f$ are stored at positions \f$ jD, \ldots, jD+D-1 \f$.
+             *
+             * Use ShapeEnum::links() to retrieve the table of a slice.
+             */
+            template<dim_t D>
+            struct ShapeSliceLinks
+            {
+                typedef std::uint32_t ordinal_type;
+
+                /**
+                 * \brief Marks a backward neighbour that does not exist, since \f$ k_d = 0 \f$.
+                 */
+                static const ordinal_type npos = std::numeric_limits<ordinal_type>::max();
+
+                /**
+                 * \brief Position of \f$ \underline{k}-\underline{e}^d \f$ within the previous slice or npos.
+                 */
+                std::vector<ordinal_type> backward;
+
+                /**
+                 * \brief Square root of the entries: \f$ \sqrt{k_d} \f$.
+                 */
+                std::vector<real_t> sqrt;
+
+                /**
+                 * \brief Recursion axis: first non-zero entry of \f$ \underline{k} \f$.
+                 *
+                 * The recursion reaches \f$ \underline{k} \f$ from its backward neighbour along this axis.
+                 * Equals \f$ D \f$ for the node \f$ \underline{0} \f$.
+                 */
+                std::vector<dim_t> axis;
+
+                /**
+                 * \brief Retrieves the number of nodes in the slice.
+                 */
+                std::size_t size() const
+                {
+                    return axis.size();
+                }
+            };
+
+            template<dim_t D>
+            const typename ShapeSliceLinks<D>::ordinal_type ShapeSliceLinks<D>::npos;
+
             /**
              * \brief A shape enumeration is a complete, ordered list of all
              * lattice nodes that are part of the basis shape.
@@ -360,6 +793,53 @@ namespace waveblocks {
                 std::size_t n_entries_;
                 MultiIndex limits_;
 
+                std::shared_ptr< const ShapeSliceIndexer<D> > indexer_;
+
+                /**
+                 * Lazily built neighbour links of all slices. Once published, the table is never replaced.
+                 */
+                mutable std::shared_ptr< const std::vector< ShapeSliceLinks<D> > > links_;
+
+                std::vector< ShapeSliceLinks<D> > build_links_() const
+                {
+                    typedef typename ShapeSliceLinks<D>::ordinal_type ordinal_type;
+
+                    std::vector< ShapeSliceLinks<D> > table(slices_.size());
+
+                    for (std::size_t islice = 0; islice < slices_.size(); islice++) {
+                        ShapeSlice<D,MultiIndex> const& curr = slices_[islice];
+                        ShapeSlice<D,MultiIndex> const& prev = slice(int(islice)-1);
+
+                        if (prev.size() >= ShapeSliceLinks<D>::npos)
+                            throw std::runtime_error("slice is too large to build neighbour links");
+
+                        ShapeSliceLinks<D>& links = table[islice];
+                        links.backward.resize(curr.size()*D);
+                        links.sqrt.resize(curr.size()*D);
+                        links.axis.resize(curr.size());
+
+                        for (std::size_t j = 0; j < curr.size(); j++) {
+                            MultiIndex index = curr[j];
+
+                            std::array<std::size_t,D> ordinals = prev.find_backward_neighbours(index);
+
+                            links.axis[j] = D;
+                            for (dim_t d = D-1; d >= 0; d--) {
+                                if (index[d] != 0) {
+                                    links.axis[j] = d;
+                                    links.backward[j*D+d] = ordinal_type(ordinals[d]);
+                                }
+                                else {
+                                    links.backward[j*D+d] = ShapeSliceLinks<D>::npos;
+                                }
+                                links.sqrt[j*D+d] = std::sqrt( real_t(index[d]) );
+                            }
+                        }
+                    }
+
+                    return table;
+                }
+
             public:
                 ShapeEnum() = default;
 
@@ -381,6 +861,8 @@ namespace waveblocks {
                     , slices_(std::move(that.slices_))
                     , n_entries_(that.n_entries_)
                     , limits_(that.limits_)
+                    , indexer_(std::move(that.indexer_))
+                    , links_(std::move(that.links_))
                 { }
 
                 ShapeEnum &operator=(const ShapeEnum& that) = default;
@@ -392,6 +874,8 @@ namespace waveblocks {
                     lower_ = std::move(that.lower_);
                     upper_ = std::move(that.upper_);
                     slices_ = std::move(that.slices_);
+                    indexer_ = std::move(that.indexer_);
+                    links_ = std::move(that.links_);
                     return *this;
                 }
 
@@ -426,6 +910,126 @@ namespace waveblocks {
                         return slices_[islice];
                 }
 
+                /**
+                 * \brief Returns the precomputed neighbour links of a slice.
+                 *
+                 * The link tables of all slices are built on the first call
+                 * and reused by all further calls.
+                 * Invalid slice indices yield an empty table.
+                 *
+                 * _Thread-Safety:_ Concurrent calls are safe. If several threads trigger
+                 * the build at the same time, only one table gets published.
+                 *
+                 * \param[in] islice Ordinal of the slice.
+                 * \return Reference to the link table of the slice.
+                 */
+                const ShapeSliceLinks<D>& links(int islice) const
+                {
+                    static const ShapeSliceLinks<D> empty;
+
+                    std::shared_ptr< const std::vector< ShapeSliceLinks<D> > > table = std::atomic_load(&links_);
+
+                    if (!table) {
+                        std::shared_ptr< const std::vector< ShapeSliceLinks<D> > > expected;
+                        table = std::make_shared< const std::vector< ShapeSliceLinks<D> > >(build_links_());
+
+                        // publish table, unless another thread has been faster
+                        if (!std::atomic_compare_exchange_strong(&links_, &expected, table))
+                            table = expected;
+                    }
+
+                    if (islice < 0 || islice >= (int)table->size())
+                        return empty;
+                    else
+                        return (*table)[islice];
+                }
+
+                /**
+                 * \brief Installs precomputed neighbour links of all slices, e.g. loaded from a file.
+                 *
+                 * _Thread-Safety:_ Call this before sharing the enumeration.
+                 *
+                 * \param[in] table Link tables of all slices (see links()).
+                 */
+                void set_links(std::shared_ptr< const std::vector< ShapeSliceLinks<D> > > table)
+                {
+                    if (table && table->size() != slices_.size())
+                        throw std::invalid_argument("number of link tables != number of slices");
+
+                    links_ = std::move(table);
+                }
+
+                /**
+                 * \brief Checks whether the neighbour links have been built or installed.
+                 */
+                bool has_links() const
+                {
+                    return bool(std::atomic_load(&links_));
+                }
+
+                /**
+                 * \brief Installs a closed-form lookup into all slices, if every slice is a complete slice of the bounding box.
+                 *
+                 * Afterwards ShapeSlice::try_find(), ShapeSlice::find() and ShapeSlice::find_backward_neighbours()
+                 * compute positions instead of searching the slices.
+                 * Nodes within a slice are unique and lie inside the bounding box, thus
+                 * comparing the number of nodes of each slice with ShapeSliceIndexer::count() suffices.
+                 *
+                 * \param[in] indexer Indexer for the bounding box limits().
+                 * \return Whether the indexer has been installed.
+                 */
+                bool set_indexer(std::shared_ptr< const ShapeSliceIndexer<D> > indexer)
+                {
+                    for (int islice = 0; islice < n_slices(); islice++) {
+                        if (indexer->count(islice) != slices_[islice].size())
+                            return false;
+                    }
+
+                    for (int islice = 0; islice < n_slices(); islice++)
+                        slices_[islice]._set_indexer(indexer, islice);
+
+                    indexer_ = std::move(indexer);
+                    return true;
+                }
+
+                /**
+                 * \brief Installs a closed-form lookup for the bounding box limits(), if applicable.
+                 *
+                 * \see set_indexer(std::shared_ptr< const ShapeSliceIndexer<D> >)
+                 */
+                bool set_indexer()
+                {
+                    std::array<int,D> limits;
+                    for (dim_t d = 0; d < D; d++)
+                        limits[d] = limits_[d];
+
+                    return set_indexer(std::make_shared< const ShapeSliceIndexer<D> >(limits));
+                }
+
+                /**
+                 * \brief Builds hash tables for all slices without closed-form indexer,
+                 * such that lookups take constant time (see ShapeSlice::enable_hash_index()).
+                 *
+                 * Worthwhile for large sparse shapes, e.g. HyperbolicCutShape in high dimensions.
+                 *
+                 * _Thread-Safety:_ Call this before sharing the enumeration.
+                 */
+                void enable_hash_index()
+                {
+                    for (auto & slice : slices_) {
+                        if (!slice.indexed())
+                            slice.enable_hash_index();
+                    }
+                }
+
+                /**
+                 * \brief Retrieves the closed-form lookup of all slices or null.
+                 */
+                std::shared_ptr< const ShapeSliceIndexer<D> > const& indexer() const
+                {
+                    return indexer_;
+                }
+
                 /**
                  * \brief Returns a reference to the array containing all slices.
                  */
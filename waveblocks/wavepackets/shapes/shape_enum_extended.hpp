@@ -38,7 +38,7 @@ namespace waveblocks {
                 template<dim_t D, class MultiIndex>
                 ShapeSlice<D, MultiIndex> _extend(const ShapeSlice<D, MultiIndex>& slice, std::size_t offset)
                 {
-                    std::vector<MultiIndex> result = _extend(slice._table(), 0, D);
+                    std::vector<MultiIndex> result = _extend(std::vector<MultiIndex>(slice.begin(), slice.end()), 0, D);
 
                     return {std::move(result), offset};
                 }
@@ -2,6 +2,9 @@
 
 #include <memory>
 #include <array>
+#include <vector>
+#include <limits>
+#include <functional>
 
 #include "../../types.hpp"
 
@@ -60,6 +63,86 @@ namespace waveblocks {
                     }
                 }
 
+                /**
+                 * \brief Maps each node of a superset slice to its position within a subset slice.
+                 *
+                 * Both slices are lexically sorted, therefore a single merge walk suffices.
+                 * If the subset slice has a closed-form indexer, each node is looked up directly instead.
+                 *
+                 * \param[in] superset_slice nodes within superset slice
+                 * \param[in] subset_slice nodes within subset slice
+                 * \return For each node of \p superset_slice: position within \p subset_slice
+                 * or \e std::numeric_limits<std::size_t>::max() if the node is missing.
+                 */
+                template<dim_t D, class MultiIndex>
+                std::vector<std::size_t> subset_ordinals(const ShapeSlice<D,MultiIndex>& superset_slice,
+                                                         const ShapeSlice<D,MultiIndex>& subset_slice)
+                {
+                    std::vector<std::size_t> ordinals(superset_slice.size(), std::numeric_limits<std::size_t>::max());
+
+                    if (subset_slice.indexed()) {
+                        for (std::size_t j = 0; j < superset_slice.size(); j++) {
+                            std::size_t ordinal;
+                            if (subset_slice.try_find(superset_slice[j], ordinal))
+                                ordinals[j] = ordinal;
+                        }
+                        return ordinals;
+                    }
+
+                    std::less< MultiIndex > comp;
+
+                    auto superset_it = superset_slice.begin();
+                    auto subset_it = subset_slice.begin();
+
+                    while (superset_it != superset_slice.end() && subset_it != subset_slice.end()) {
+                        if (*superset_it == *subset_it) {
+                            ordinals[superset_it - superset_slice.begin()] = subset_it - subset_slice.begin();
+                            ++subset_it;
+                            ++superset_it;
+                        }
+                        else if (comp(*superset_it, *subset_it)) {
+                            ++superset_it;
+                        }
+                        else {
+                            ++subset_it; // node is not part of superset
+                        }
+                    }
+
+                    return ordinals;
+                }
+
+                /**
+                 * \brief Maps each node of a superset shape to its ordinal within a subset shape.
+                 *
+                 * Compute the map once and reuse it as long as both shapes stay the same,
+                 * e.g. for each evaluation of a HomogeneousHaWp.
+                 *
+                 * \param[in] superset_enum superset shape
+                 * \param[in] subset_enum subset shape
+                 * \return For each node of \p superset_enum: ordinal within \p subset_enum
+                 * or \e std::numeric_limits<std::size_t>::max() if the node is missing.
+                 */
+                template<dim_t D, class MultiIndex>
+                std::vector<std::size_t> subset_map(const ShapeEnum<D,MultiIndex>* superset_enum,
+                                                    const ShapeEnum<D,MultiIndex>* subset_enum)
+                {
+                    std::vector<std::size_t> map(superset_enum->n_entries(), std::numeric_limits<std::size_t>::max());
+
+                    for (int islice = 0; islice < superset_enum->n_slices(); islice++) {
+                        const ShapeSlice<D,MultiIndex>& superset_slice = superset_enum->slice(islice);
+                        const ShapeSlice<D,MultiIndex>& subset_slice = subset_enum->slice(islice);
+
+                        std::vector<std::size_t> ordinals = subset_ordinals(superset_slice, subset_slice);
+
+                        for (std::size_t j = 0; j < ordinals.size(); j++) {
+                            if (ordinals[j] != std::numeric_limits<std::size_t>::max())
+                                map[superset_slice.offset() + j] = subset_slice.offset() + ordinals[j];
+                        }
+                    }
+
+                    return map;
+                }
+
                 template<dim_t D, class MultiIndex, int N>
                 HaWpBasisVector<N> copy_subset(const HaWpBasisVector<N>& superset_data,
                                                const ShapeSlice<D,MultiIndex>& superset_slice,
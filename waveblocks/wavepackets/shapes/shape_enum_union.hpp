@@ -86,9 +86,9 @@ namespace waveblocks {
                 /**
                  *
                  */
-                template<class MultiIndex>
-                std::vector<MultiIndex> strict_union(std::vector< typename std::vector<MultiIndex>::const_iterator > begin,
-                                                     std::vector< typename std::vector<MultiIndex>::const_iterator > end)
+                template<class MultiIndex, class Iterator = typename std::vector<MultiIndex>::const_iterator>
+                std::vector<MultiIndex> strict_union(std::vector< Iterator > begin,
+                                                     std::vector< Iterator > end)
                 {
                     assert( begin.size() == end.size() );
 
@@ -139,15 +139,15 @@ namespace waveblocks {
                 template<dim_t D, class MultiIndex>
                 ShapeSlice<D, MultiIndex> strict_union(const std::vector< const ShapeSlice<D, MultiIndex>* >& slices, std::size_t union_offset)
                 {
-                    std::vector< typename std::vector<MultiIndex>::const_iterator > begin(slices.size());
-                    std::vector< typename std::vector<MultiIndex>::const_iterator > end(slices.size());
+                    std::vector< typename ShapeSlice<D, MultiIndex>::const_iterator > begin(slices.size());
+                    std::vector< typename ShapeSlice<D, MultiIndex>::const_iterator > end(slices.size());
 
                     for (std::size_t i = 0; i < slices.size(); i++) {
                         begin[i] = slices[i]->cbegin();
                         end[i] = slices[i]->cend();
                     }
 
-                    std::vector<MultiIndex> superset = strict_union<MultiIndex>(begin, end);
+                    std::vector<MultiIndex> superset = strict_union<MultiIndex, typename ShapeSlice<D, MultiIndex>::const_iterator>(begin, end);
 
                     return {std::move(superset), union_offset};
                 }
@@ -180,7 +180,12 @@ namespace waveblocks {
                         offset += superset[islice].size();
                     }
 
-                    return {std::move(superset), offset, limits};
+                    ShapeEnum<D, MultiIndex> result{std::move(superset), offset, limits};
+
+                    // e.g. the union of nested hypercubic shapes is hypercubic again
+                    result.set_indexer();
+
+                    return result;
                 }
 
                 /**
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <memory>
+#include <typeinfo>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "../../types.hpp"
 
 #include "shape_enum.hpp"
 #include "shape_base.hpp"
+#include "shape_hypercubic.hpp"
+#include "shape_hyperbolic.hpp"
 
 
 namespace waveblocks {
@@ -19,17 +28,172 @@ namespace waveblocks {
              * AbstractShape and converts the information to a ShapeEnum.
              *
              * \tparam D The basis shape dimensionality.
-             * \tparam MultiIndex The type to represent a multi-index. TinyMultiIndex is a valid type.
+             * \tparam MultiIndex The type to represent a multi-index. TinyMultiIndex and WideMultiIndex are valid types.
              */
             template<dim_t D, class MultiIndex>
             class ShapeEnumerator
             {
-            public:
+            private:
                 /**
-                 * \deprecated Use member function enumerate instead.
+                 * \brief Calls the member functions of a built-in shape without virtual dispatch,
+                 * such that the compiler can inline them into the enumeration loop.
                  */
                 template<class Shape>
-                ShapeEnum<D,MultiIndex> generate(const Shape& shape) const
+                struct NonVirtualShape
+                {
+                    Shape const& shape;
+
+                    int limit(int const* base_node, dim_t axis) const
+                    {
+                        return shape.Shape::limit(base_node, axis);
+                    }
+
+                    int bbox(dim_t axis) const
+                    {
+                        return shape.Shape::bbox(axis);
+                    }
+                };
+
+                /**
+                 * \brief Returns the shape as \p Target, if its dynamic type is exactly \p Target, otherwise null.
+                 */
+                template<class Target, class Shape>
+                static typename std::enable_if<std::is_base_of<Shape,Target>::value, Target const*>::type
+                exact_cast_(Shape const& shape)
+                {
+                    return typeid(shape) == typeid(Target) ? static_cast<Target const*>(&shape) : nullptr;
+                }
+
+                template<class Target, class Shape>
+                static typename std::enable_if<!std::is_base_of<Shape,Target>::value, Target const*>::type
+                exact_cast_(Shape const&)
+                {
+                    return nullptr;
+                }
+
+                /**
+                 * \brief Nodes of one block in lexical order, grouped by slice.
+                 */
+                struct Block
+                {
+                    std::array<int,D> prefix;
+                    std::size_t first_slice;
+                    std::vector< std::vector<MultiIndex> > slices;
+                };
+
+                /**
+                 * \brief Enumerates all nodes whose entries on the axes \f$ 0, \ldots, first-1 \f$ equal \p node.
+                 *
+                 * Entries of \p node on the other axes must be zero.
+                 * Nodes of slice \f$ s \f$ are appended to \f$ mindices[s - base] \f$.
+                 */
+                template<class Shape>
+                static void enumerate_block_(Shape const& shape, std::array<int,D> node, dim_t first,
+                                             std::vector< std::vector<MultiIndex> >& mindices, std::size_t base)
+                {
+                    MultiIndex index{}; //zero initialize
+                    std::size_t islice = 0;
+                    for (dim_t d = 0; d < D; d++) {
+                        index[d] = node[d];
+                        islice += node[d];
+                    }
+                    islice -= base;
+
+                    while (true) {
+                        // iterate over last axis
+                        int last = shape.limit(node.data(), D-1);
+                        if (last >= 0 && mindices.size() < islice + last + 1)
+                            mindices.resize(islice + last + 1);
+
+                        for (int i = 0; i <= last; i++) {
+                            index[D-1] = i;
+                            mindices[islice+i].push_back(index);
+                        }
+                        index[D-1] = 0;
+
+                        // iterate over other axes
+                        dim_t j = D-2;
+                        if (j < first)
+                            return;
+
+                        while (node[j] >= shape.limit(node.data(), j)) {
+                            islice -= node[j];
+                            node[j] = 0;
+                            index[j] = 0;
+                            if (j == first)
+                                return;
+                            else
+                                j = j-1;
+                        }
+                        islice += 1;
+                        node[j] += 1;
+                        index[j] = node[j];
+                    }
+                }
+
+                /**
+                 * \brief Enumerates the nodes in parallel.
+                 *
+                 * The shape is partitioned into blocks that share the entries on the leading axes (the prefix).
+                 * Since nodes are ordered lexically, concatenating the slices of all blocks in the order of
+                 * their prefixes yields sorted slices.
+                 */
+                template<class Shape>
+                static void enumerate_parallel_(Shape const& shape, std::vector< std::vector<MultiIndex> >& mindices)
+                {
+                    // collect prefixes on the leading axes, use more axes until there are enough blocks
+                    std::vector<Block> blocks;
+                    dim_t nprefix = 0;
+                    while (nprefix < D-1 && blocks.size() < 64) {
+                        nprefix++;
+                        blocks.clear();
+
+                        std::array<int,D> node{}; //zero initialize
+                        while (true) {
+                            blocks.push_back(Block{node, 0, {}});
+
+                            dim_t j = nprefix-1;
+                            while (node[j] >= shape.limit(node.data(), j)) {
+                                node[j] = 0;
+                                if (j == 0)
+                                    goto prefixes_complete;
+                                j = j-1;
+                            }
+                            node[j] += 1;
+                        }
+                    prefixes_complete:
+                        (void)0;
+                    }
+
+                    #pragma omp parallel for schedule(dynamic)
+                    for (long ib = 0; ib < (long)blocks.size(); ib++) {
+                        Block& block = blocks[ib];
+                        for (dim_t d = 0; d < nprefix; d++)
+                            block.first_slice += block.prefix[d];
+
+                        enumerate_block_(shape, block.prefix, nprefix, block.slices, block.first_slice);
+                    }
+
+                    std::vector<std::size_t> sizes(mindices.size(), 0);
+                    for (auto const& block : blocks) {
+                        for (std::size_t k = 0; k < block.slices.size(); k++)
+                            sizes[block.first_slice + k] += block.slices[k].size();
+                    }
+
+                    #pragma omp parallel for schedule(dynamic)
+                    for (long islice = 0; islice < (long)mindices.size(); islice++) {
+                        mindices[islice].reserve(sizes[islice]);
+                        for (auto const& block : blocks) {
+                            if ((std::size_t)islice >= block.first_slice && (std::size_t)islice < block.first_slice + block.slices.size()) {
+                                auto const& part = block.slices[islice - block.first_slice];
+                                mindices[islice].insert(mindices[islice].end(), part.begin(), part.end());
+                            }
+                        }
+                    }
+                }
+
+                template<class Shape>
+                ShapeEnum<D,MultiIndex> generate_(const Shape& shape) const
                 {
                     std::vector< std::vector<MultiIndex> > mindices;
 
@@ -55,41 +219,14 @@ namespace waveblocks {
                     }
 
                     // enumerate shape and store all multi-indices
-                    {
-                        MultiIndex index{}; //zero initialize
-                        std::size_t islice = 0;
-
-                        while (true) {
-                            // iterate over last axis
-                            for (dim_t i = 0; i <= shape.limit(static_cast<std::array<int,D> >(index).data(),D-1); i++) {
-                                index[D-1] = i;
-
-                                //                     if (use_dict)
-                                //                         mindices[islice+i].dict_[index] = mindices[islice+i].table_.size();
-
-                                mindices[islice+i].push_back(index);
-                            }
-                            index[D-1] = 0;
-
-                            // iterate over other axes
-                            if (D > 1) {
-                                dim_t j = D-2;
-                                while ((int)index[j] == shape.limit(static_cast<std::array<int,D> >(index).data(),j)) {
-                                    islice -= index[j];
-                                    index[j] = 0;
-                                    if (j == 0)
-                                        goto enumeration_complete;
-                                    else
-                                        j = j-1;
-                                }
-                                islice += 1;
-                                index[j] += 1;
-                            }
-                            else break;
-                        }
-                    enumeration_complete:
-                        (void)0;
-                    }
+                    bool threaded = false;
+#ifdef _OPENMP
+                    threaded = parallel && omp_get_max_threads() > 1;
+#endif
+                    if (threaded && D > 1)
+                        enumerate_parallel_(shape, mindices);
+                    else
+                        enumerate_block_(shape, std::array<int,D>{}, 0, mindices, 0);
 
                     std::vector< ShapeSlice<D,MultiIndex> > slices(mindices.size());
 
@@ -111,7 +248,41 @@ namespace waveblocks {
                     for (dim_t d = 0; d < D; d++)
                         limits[d] = shape.bbox(d);
 
-                    return {std::move(slices), size, limits};
+                    ShapeEnum<D,MultiIndex> enumeration{std::move(slices), size, limits};
+
+                    // closed-form lookup, if the shape fills its bounding box slice by slice (e.g. hypercubic shapes)
+                    enumeration.set_indexer();
+
+                    return enumeration;
+                }
+
+            public:
+                /**
+                 * \brief Whether to enumerate blocks of the shape on separate threads (using OpenMP).
+                 *
+                 * Takes effect only if OpenMP provides more than one thread. The result does not depend on this setting.
+                 */
+                bool parallel = true;
+
+                /**
+                 * Built-in shapes (HyperCubicShape, HyperbolicCutShape, LimitedHyperbolicCutShape)
+                 * are enumerated without virtual calls.
+                 *
+                 * \deprecated Use member function enumerate instead.
+                 */
+                template<class Shape>
+                ShapeEnum<D,MultiIndex> generate(const Shape& shape) const
+                {
+                    if (auto cube = exact_cast_< HyperCubicShape<D> >(shape))
+                        return generate_(NonVirtualShape< HyperCubicShape<D> >{*cube});
+
+                    if (auto cut = exact_cast_< HyperbolicCutShape<D> >(shape))
+                        return generate_(NonVirtualShape< HyperbolicCutShape<D> >{*cut});
+
+                    if (auto cut = exact_cast_< LimitedHyperbolicCutShape<D> >(shape))
+                        return generate_(NonVirtualShape< LimitedHyperbolicCutShape<D> >{*cut});
+
+                    return generate_(shape);
                 }
 
                 /**
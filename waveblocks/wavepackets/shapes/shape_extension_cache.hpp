@@ -4,15 +4,14 @@
 
 #include "shape_enum_union.hpp"
 #include "shape_enum_extended.hpp"
+#include "shape_registry.hpp"
+#include "../../utilities/atomic_shared_ptr.hpp"
 
 
 namespace waveblocks {
     namespace wavepackets {
         namespace shapes {
 
-            template<dim_t D, class MultiIndex>
-            using ShapeEnumSharedPtr = std::shared_ptr< ShapeEnum<D, MultiIndex> >;
-
             // template<dim_t D>
             // class AbstractScalarWavepacket
             // {
@@ -22,6 +21,14 @@ namespace waveblocks {
             // };
 
 
+            /**
+             * \brief Caches the extension of a wavepacket's basis shape.
+             *
+             * _Thread-Safety:_ Concurrent calls are safe. The source and its extension are published
+             * together as an immutable snapshot, thus readers never see an extension of another source.
+             * Threads that find the cache outdated at the same time may both store the extension;
+             * since extensions come from the ShapeRegistry, they store the same instance.
+             */
             template<dim_t D, class MultiIndex>
             class ShapeExtensionCache
             {
@@ -32,10 +39,12 @@ namespace waveblocks {
                  */
                 ShapeEnumSharedPtr<D,MultiIndex> get_extended_shape(std::shared_ptr< ShapeEnum<D,MultiIndex> > shape) const
                 {
-                    if (shape.get() != cached_extended_shape_source_)
-                        update_extended_shape(shape); // this function is not thread-safe
+                    std::shared_ptr<const Snapshot> snapshot = snapshot_.load();
+
+                    if (snapshot && utilities::same_owner(snapshot->source, shape))
+                        return snapshot->extension;
 
-                    return cached_extended_shape_;
+                    return update_(shape);
                 }
 
                 /**
@@ -47,26 +56,37 @@ namespace waveblocks {
                 void set_extended_shape(std::shared_ptr< ShapeEnum<D,MultiIndex> > shape,
                                         std::shared_ptr< ShapeEnum<D,MultiIndex> > extension)
                 {
-                    cached_extended_shape_source_ = shape.get();
-                    cached_extended_shape_ = extension;
+                    snapshot_.store(std::make_shared<const Snapshot>(Snapshot{shape, extension}));
                 }
 
                 /**
                  * \brief Recomputes extended shape if source shape changed.
                  *
+                 * The extension is taken from the ShapeRegistry, thus identical shapes
+                 * of different packets share one extension.
+                 *
                  * \param shape new source shape
                  */
                 void update_extended_shape(std::shared_ptr< ShapeEnum<D,MultiIndex> > shape) const
                 {
-                    if (shape.get() != cached_extended_shape_source_) {
-                        cached_extended_shape_source_ = shape.get();
-                        cached_extended_shape_ = std::make_shared< ShapeEnum<D,MultiIndex> >(shapes::shape_enum::extend(shape.get()));
-                    }
+                    get_extended_shape(shape);
                 }
 
             private:
-                mutable ShapeEnumSharedPtr<D,MultiIndex> cached_extended_shape_;
-                mutable ShapeEnum<D,MultiIndex> * cached_extended_shape_source_; // source of the cached extended shape
+                struct Snapshot
+                {
+                    std::weak_ptr< ShapeEnum<D,MultiIndex> > source;
+                    ShapeEnumSharedPtr<D,MultiIndex> extension;
+                };
+
+                ShapeEnumSharedPtr<D,MultiIndex> update_(std::shared_ptr< ShapeEnum<D,MultiIndex> > const& shape) const
+                {
+                    auto snapshot = std::make_shared<const Snapshot>(Snapshot{shape, ShapeRegistry<D,MultiIndex>::instance().extension(shape)});
+                    snapshot_.store(snapshot);
+                    return snapshot->extension;
+                }
+
+                mutable utilities::AtomicSharedPtr<const Snapshot> snapshot_;
             };
         }
     }
@@ -64,6 +64,12 @@ namespace waveblocks {
                 {
                     out << "HyperbolicCutShape{sparsity: " << S_ << "}";
                 }
+
+                virtual bool identity(std::ostream & out) const override
+                {
+                    out << "HyperbolicCutShape<" << D << "> " << S_;
+                    return true;
+                }
             };
 
             /**
@@ -166,6 +172,14 @@ namespace waveblocks {
                     out << limits_[D-1] << "]";
                     out << "}";
                 }
+
+                virtual bool identity(std::ostream & out) const override
+                {
+                    out << "LimitedHyperbolicCutShape<" << D << "> " << S_;
+                    for (dim_t d = 0; d < D; d++)
+                        out << " " << limits_[d];
+                    return true;
+                }
             };
         }
     }
@@ -102,6 +102,14 @@ namespace waveblocks {
                     out << limits_[D-1] << "]";
                     out << "}";
                 }
+
+                virtual bool identity(std::ostream & out) const override
+                {
+                    out << "HyperCubicShape<" << D << ">";
+                    for (dim_t d = 0; d < D; d++)
+                        out << " " << limits_[d];
+                    return true;
+                }
             };
         }
     }
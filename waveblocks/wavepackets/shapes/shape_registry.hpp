@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../types.hpp"
+
+#include "shape_base.hpp"
+#include "shape_enum.hpp"
+#include "shape_enum_union.hpp"
+#include "shape_enum_extended.hpp"
+#include "shape_enumerator.hpp"
+
+
+namespace waveblocks {
+    namespace wavepackets {
+        namespace shapes {
+
+            template<dim_t D, class MultiIndex>
+            using ShapeEnumSharedPtr = std::shared_ptr< ShapeEnum<D, MultiIndex> >;
+
+            /**
+             * \brief Process-wide registry that hands out one shared instance per distinct shape enumeration.
+             *
+             * Ensembles and multi-component packets often hold many identical enumerations.
+             * The registry hash-conses them: intern() returns the registered instance with the same nodes,
+             * thus packets share memory, and extension() and strict_union() compute the extension
+             * respectively the union of the same shapes only once.
+             *
+             * The registry holds only weak references to the shapes it hands out, thus unused shapes
+             * are freed as usual. An extension or union keeps its sources alive and stays cached as long as it is in use.
+             * The registry never shares the caller's object: intern() registers a copy of a new enumeration,
+             * thus later changes of the caller's object cannot affect other packets.
+             * Interned shapes are shared and must not be modified.
+             *
+             * \code{.cpp}
+             * auto& registry = ShapeRegistry<D,MultiIndex>::instance();
+             * packet.shape() = registry.intern(LimitedHyperbolicCutShape<D>(7, {5,5,5}));
+             * \endcode
+             *
+             * _Thread-Safety:_ All member functions may be called concurrently.
+             * Expensive work (enumeration, extension, union) runs outside of the lock, therefore
+             * concurrent requests for the same new shape may compute it several times, but all of them
+             * receive the same instance.
+             *
+             * \tparam D The basis shape dimensionality.
+             * \tparam MultiIndex The type to represent a multi-index.
+             */
+            template<dim_t D, class MultiIndex>
+            class ShapeRegistry
+            {
+            public:
+                typedef ShapeEnumSharedPtr<D,MultiIndex> Pointer;
+
+            private:
+                typedef std::weak_ptr< ShapeEnum<D,MultiIndex> > WeakPointer;
+
+                /**
+                 * Cache entry of an extension or union, which is valid as long as its sources and its result are alive.
+                 * A union that equals one of its sources refers to it by position.
+                 */
+                struct Derived
+                {
+                    std::vector<WeakPointer> sources;
+                    WeakPointer result;
+                    int source = -1;
+                };
+
+                /**
+                 * Computed extension or union, which keeps its registered sources alive.
+                 * Otherwise a source only referred to by the cache entry would be freed at once.
+                 */
+                struct DerivedShape
+                {
+                    ShapeEnum<D,MultiIndex> shape;
+                    std::vector<Pointer> sources;
+                };
+
+                mutable std::mutex mutex_;
+
+                /**
+                 * Registered shapes by content hash.
+                 */
+                std::unordered_multimap<std::size_t, WeakPointer> by_content_;
+
+                /**
+                 * Registered shapes by identity key of their description (see AbstractShape::identity()).
+                 */
+                std::unordered_map<std::string, WeakPointer> by_identity_;
+
+                /**
+                 * Extensions and unions by the addresses of their registered sources.
+                 */
+                std::map< std::vector<ShapeEnum<D,MultiIndex> const*>, Derived > extensions_;
+                std::map< std::vector<ShapeEnum<D,MultiIndex> const*>, Derived > unions_;
+
+                std::size_t sweep_size_ = 64;
+
+                static std::size_t hash_(ShapeEnum<D,MultiIndex> const& shape)
+                {
+                    std::hash<MultiIndex> hash;
+
+                    std::uint64_t h = shape.n_entries();
+                    for (auto const& slice : shape.slices()) {
+                        for (auto const& index : slice)
+                            h = (h ^ std::uint64_t(hash(index))) * UINT64_C(0x100000001B3);
+                    }
+                    return std::size_t(h);
+                }
+
+                static bool same_(ShapeEnum<D,MultiIndex> const& a, ShapeEnum<D,MultiIndex> const& b)
+                {
+                    return a.n_slices() == b.n_slices() && a.limits() == b.limits() && a == b;
+                }
+
+                static bool alive_(Derived const& entry)
+                {
+                    for (auto const& source : entry.sources) {
+                        if (source.expired())
+                            return false;
+                    }
+                    return entry.source >= 0 || !entry.result.expired();
+                }
+
+                /**
+                 * \brief Drops entries of freed shapes, whenever the registry has doubled in size (or if forced).
+                 */
+                void sweep_(bool force = false)
+                {
+                    std::size_t size = by_content_.size() + by_identity_.size() + extensions_.size() + unions_.size();
+                    if (size < sweep_size_ && !force)
+                        return;
+
+                    for (auto it = by_content_.begin(); it != by_content_.end(); )
+                        it = it->second.expired() ? by_content_.erase(it) : std::next(it);
+
+                    for (auto it = by_identity_.begin(); it != by_identity_.end(); )
+                        it = it->second.expired() ? by_identity_.erase(it) : std::next(it);
+
+                    for (auto* table : {&extensions_, &unions_}) {
+                        for (auto it = table->begin(); it != table->end(); )
+                            it = alive_(it->second) ? std::next(it) : table->erase(it);
+                    }
+
+                    size = by_content_.size() + by_identity_.size() + extensions_.size() + unions_.size();
+                    sweep_size_ = std::max<std::size_t>(64, 2*size);
+                }
+
+                /**
+                 * \brief Looks up the registered instance with the same nodes as \p shape. Requires the lock.
+                 */
+                Pointer find_locked_(Pointer const& shape, std::size_t hash) const
+                {
+                    auto range = by_content_.equal_range(hash);
+                    for (auto it = range.first; it != range.second; ++it) {
+                        Pointer registered = it->second.lock();
+                        if (registered && (registered == shape || same_(*registered, *shape)))
+                            return registered;
+                    }
+                    return nullptr;
+                }
+
+                /**
+                 * \brief Looks up the registered instance with the same nodes or registers \p shape,
+                 * which must be owned by the registry. Requires the lock.
+                 */
+                Pointer intern_locked_(Pointer const& shape, std::size_t hash)
+                {
+                    if (Pointer registered = find_locked_(shape, hash))
+                        return registered;
+
+                    sweep_();
+                    by_content_.emplace(hash, shape);
+                    return shape;
+                }
+
+                /**
+                 * \brief Looks up a cached extension or union of the registered \p sources. Requires the lock.
+                 */
+                static Pointer find_derived_(std::map< std::vector<ShapeEnum<D,MultiIndex> const*>, Derived > const& table,
+                                             std::vector<ShapeEnum<D,MultiIndex> const*> const& key)
+                {
+                    auto it = table.find(key);
+                    if (it == table.end() || !alive_(it->second))
+                        return nullptr;
+                    if (it->second.source >= 0)
+                        return it->second.sources[it->second.source].lock();
+                    return it->second.result.lock();
+                }
+
+                template<class Compute>
+                Pointer derive_(std::map< std::vector<ShapeEnum<D,MultiIndex> const*>, Derived >& table,
+                                std::vector<Pointer> const& sources,
+                                Compute compute)
+                {
+                    std::vector<Pointer> registered(sources.size());
+                    std::vector<ShapeEnum<D,MultiIndex> const*> key(sources.size());
+                    for (std::size_t i = 0; i < sources.size(); i++) {
+                        registered[i] = intern(sources[i]);
+                        key[i] = registered[i].get();
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (Pointer result = find_derived_(table, key))
+                            return result;
+                    }
+
+                    auto derived = std::make_shared<DerivedShape>();
+                    derived->shape = compute(registered);
+                    derived->sources = registered;
+
+                    Pointer result(derived, &derived->shape);
+                    std::size_t hash = hash_(*result);
+
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (Pointer other = find_derived_(table, key))
+                        return other;
+
+                    result = intern_locked_(result, hash);
+
+                    Derived& entry = table[key];
+                    entry.sources.assign(registered.begin(), registered.end());
+                    entry.result = result;
+                    entry.source = -1;
+                    for (std::size_t i = 0; i < registered.size(); i++) {
+                        if (registered[i] == result) {
+                            entry.result.reset();
+                            entry.source = int(i);
+                        }
+                    }
+                    return result;
+                }
+
+            public:
+                /**
+                 * \brief Returns the process-wide registry.
+                 */
+                static ShapeRegistry& instance()
+                {
+                    static ShapeRegistry registry;
+                    return registry;
+                }
+
+                /**
+                 * \brief Returns the registered enumeration with the same nodes as \p shape.
+                 *
+                 * If there is none, a copy of \p shape gets registered and returned,
+                 * thus the shared instance is never the caller's object.
+                 *
+                 * _Complexity:_ Linear in the number of nodes (hashing, comparison and copy).
+                 */
+                Pointer intern(Pointer const& shape)
+                {
+                    if (!shape)
+                        return shape;
+
+                    std::size_t hash = hash_(*shape);
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (Pointer registered = find_locked_(shape, hash))
+                            return registered;
+                    }
+
+                    Pointer copy = std::make_shared< ShapeEnum<D,MultiIndex> >(*shape);
+
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    return intern_locked_(copy, hash);
+                }
+
+                /**
+                 * \brief Same as intern(Pointer const&), but takes over a new enumeration instead of copying it.
+                 */
+                Pointer intern(ShapeEnum<D,MultiIndex>&& shape)
+                {
+                    Pointer owned = std::make_shared< ShapeEnum<D,MultiIndex> >(std::move(shape));
+                    std::size_t hash = hash_(*owned);
+
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    return intern_locked_(owned, hash);
+                }
+
+                /**
+                 * \brief Returns the registered enumeration of a shape description.
+                 *
+                 * Descriptions are identified by their identity key (see AbstractShape::identity()),
+                 * thus a known description is not enumerated again.
+                 * A new description, or one without key, is enumerated and then interned by content.
+                 */
+                Pointer intern(AbstractShape<D> const& shape)
+                {
+                    std::ostringstream out;
+                    if (!shape.identity(out))
+                        return intern(ShapeEnumerator<D,MultiIndex>().generate(shape));
+
+                    std::string key = out.str();
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        auto it = by_identity_.find(key);
+                        if (it != by_identity_.end()) {
+                            if (Pointer registered = it->second.lock())
+                                return registered;
+                        }
+                    }
+
+                    Pointer registered = intern(ShapeEnumerator<D,MultiIndex>().generate(shape));
+
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    sweep_();
+                    by_identity_[key] = registered;
+                    return registered;
+                }
+
+                /**
+                 * \brief Returns the registered extension (see shape_enum::extend()) of a shape.
+                 *
+                 * The extension is computed once per distinct shape and cached as long as it is in use.
+                 */
+                Pointer extension(Pointer const& shape)
+                {
+                    return derive_(extensions_, {shape}, [](std::vector<Pointer> const& sources) {
+                        return shape_enum::extend(sources[0].get());
+                    });
+                }
+
+                /**
+                 * \brief Returns the registered union (see shape_enum::strict_union()) of shapes.
+                 *
+                 * The union is computed once per distinct list of shapes and cached as long as it is in use.
+                 */
+                Pointer strict_union(std::vector<Pointer> const& shapes)
+                {
+                    return derive_(unions_, shapes, [](std::vector<Pointer> const& sources) {
+                        std::vector< ShapeEnum<D,MultiIndex> const* > list(sources.size());
+                        for (std::size_t i = 0; i < sources.size(); i++)
+                            list[i] = sources[i].get();
+                        return shape_enum::strict_union<D,MultiIndex>(list);
+                    });
+                }
+
+                /**
+                 * \brief Retrieves the number of registered enumerations that are still in use.
+                 *
+                 * Drops cached extensions and unions of freed shapes first.
+                 */
+                std::size_t size()
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    sweep_(true);
+
+                    std::size_t count = 0;
+                    for (auto const& entry : by_content_) {
+                        if (!entry.second.expired())
+                            count++;
+                    }
+                    return count;
+                }
+            };
+        }
+    }
+}
@@ -32,7 +32,7 @@ namespace waveblocks {
              * }
              * \endcode
              *
-             * If TinyMultiIndex is not enough for you. You will have to implement your own type.
+             * If TinyMultiIndex is not enough for you, use WideMultiIndex or implement your own type.
              * A custom implementation
              * must possess the same semantics as std::array<int,D>.
              * Furthermore it has to specialize std::less, that performs lexical index comparison
@@ -162,9 +162,7 @@ namespace waveblocks {
                     : values_(0)
                 { }
 
-                TinyMultiIndex(const TinyMultiIndex &that)
-                    : values_(that.values_)
-                { }
+                TinyMultiIndex(const TinyMultiIndex &that) = default;
 
                 TinyMultiIndex(const std::array<int,D> &that)
                 {
@@ -183,12 +181,7 @@ namespace waveblocks {
                     }
                 }
 
-                TinyMultiIndex &operator=(const TinyMultiIndex &that)
-                {
-                    values_ = that.values_;
-
-                    return *this;
-                }
+                TinyMultiIndex &operator=(const TinyMultiIndex &that) = default;
 
                 int operator[](dim_t index) const
                 {
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <iostream>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+
+#include "../../types.hpp"
+
+
+namespace waveblocks {
+    namespace wavepackets {
+        namespace shapes {
+            /**
+             * \brief Represents a multi-index using one 8-bit or 16-bit lane per entry.
+             *
+             * TinyMultiIndex packs all entries into a single integer, thus the largest entry shrinks
+             * with the dimensionality (63 for \f$ D=10 \f$ with a 64-bit integer) and every access
+             * shifts and masks through a proxy. This class stores the entries in plain lanes
+             * (255 resp. 65535 is the largest entry regardless of \f$ D \f$),
+             * which are padded with zeros to a multiple of 128 bits, e.g.
+             * 16 bytes for \f$ D=10 \f$ with 8-bit lanes and 32 bytes for \f$ D=10 \f$ with 16-bit lanes.
+             *
+             * Comparison, equality and hashing operate on whole 64-bit words, i.e. on 8 resp. 4 entries at once.
+             * The lexicographic std::less locates the first differing word and compares it as
+             * a big-endian integer (one byte swap), without looking at single entries.
+             * Equality and hashing combine all words without branches, thus the compiler
+             * keeps them in 128-bit or 256-bit registers.
+             *
+             * Writing an entry larger than the lane truncates it. Code that creates multi-indices
+             * should check for overflows in the same way as for TinyMultiIndex
+             * (ShapeEnumerator does so).
+             *
+             * \tparam UINT Lane type: std::uint8_t or std::uint16_t.
+             * \tparam D Dimensionality of multi-index i.e number of entries.
+             */
+            template<class UINT, dim_t D>
+            class WideMultiIndex
+            {
+                static_assert(std::is_unsigned<UINT>::value && (sizeof(UINT) == 1 || sizeof(UINT) == 2),
+                              "lane type must be std::uint8_t or std::uint16_t");
+
+                friend struct std::less<waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> >;
+                friend struct std::hash<waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> >;
+                friend struct std::equal_to<waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> >;
+
+            public:
+                /**
+                 * \brief Size of the representation: entries padded to a multiple of 128 bits.
+                 */
+                const static std::size_t BYTES = ((D*sizeof(UINT) + 15)/16)*16;
+
+                const static std::size_t WORDS = BYTES/sizeof(std::uint64_t);
+
+                const static std::size_t LANES_PER_WORD = sizeof(std::uint64_t)/sizeof(UINT);
+
+            private:
+                /**
+                 * \brief Returns the largest value that this implementation is able to store.
+                 */
+                static int limit()
+                {
+                    return std::numeric_limits<UINT>::max();
+                }
+
+                alignas(16) UINT lanes_[BYTES/sizeof(UINT)];
+
+                std::uint64_t word_(std::size_t w) const
+                {
+                    std::uint64_t word;
+                    std::memcpy(&word, lanes_ + w*LANES_PER_WORD, sizeof(word));
+                    return word;
+                }
+
+                /**
+                 * \brief Reorders the bytes of a word, such that integer order equals lexicographic order of its lanes.
+                 */
+                static std::uint64_t key_(std::uint64_t word)
+                {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+                    // first lane occupies the most significant bits
+                    return word;
+#else
+                    if (sizeof(UINT) == 2)
+                        word = ((word & UINT64_C(0x00FF00FF00FF00FF)) << 8) | ((word >> 8) & UINT64_C(0x00FF00FF00FF00FF));
+#if defined(__GNUC__)
+                    return __builtin_bswap64(word);
+#else
+                    std::uint64_t key = 0;
+                    for (std::size_t byte = 0; byte < sizeof(word); byte++, word >>= 8)
+                        key = (key << 8) | (word & 0xFF);
+                    return key;
+#endif
+#endif
+                }
+
+                /**
+                 * \brief Whether \p first precedes \p second lexicographically.
+                 */
+                static bool less_(const WideMultiIndex &first, const WideMultiIndex &second)
+                {
+                    for (std::size_t w = 0; w + 1 < WORDS; w++) {
+                        std::uint64_t a = first.word_(w);
+                        std::uint64_t b = second.word_(w);
+                        if (a != b)
+                            return key_(a) < key_(b);
+                    }
+                    return key_(first.word_(WORDS-1)) < key_(second.word_(WORDS-1));
+                }
+
+                static bool equal_(const WideMultiIndex &first, const WideMultiIndex &second)
+                {
+                    std::uint64_t diff = 0;
+                    for (std::size_t w = 0; w < WORDS; w++)
+                        diff |= first.word_(w) ^ second.word_(w);
+                    return diff == 0;
+                }
+
+            public:
+                WideMultiIndex()
+                    : lanes_()
+                { }
+
+                WideMultiIndex(const WideMultiIndex &that) = default;
+
+                WideMultiIndex(const std::array<int,D> &that)
+                    : lanes_()
+                {
+                    for (dim_t d = 0; d < D; d++)
+                        lanes_[d] = that[d];
+                }
+
+                WideMultiIndex(std::initializer_list<int> list)
+                    : lanes_()
+                {
+                    dim_t axis = 0;
+                    for (typename std::initializer_list<int>::iterator it = list.begin(); it != list.end() && axis < D; it++) {
+                        if (*it > limit())
+                            throw std::range_error("this multi-index implementation is unable to store a larger value than " + std::to_string(limit()));
+
+                        lanes_[axis++] = *it;
+                    }
+                }
+
+                WideMultiIndex &operator=(const WideMultiIndex &that) = default;
+
+                int operator[](dim_t index) const
+                {
+                    return lanes_[index];
+                }
+
+                UINT &operator[](dim_t index)
+                {
+                    return lanes_[index];
+                }
+
+                bool operator==(const WideMultiIndex &that) const
+                {
+                    return equal_(*this, that);
+                }
+
+                bool operator!=(const WideMultiIndex &that) const
+                {
+                    return !equal_(*this, that);
+                }
+
+                operator std::array<int,D>() const
+                {
+                    std::array<int,D> copy;
+                    for (dim_t d = 0; d < D; d++) {
+                        copy[d] = lanes_[d];
+                    }
+                    return copy;
+                }
+            };
+
+            template<class UINT, dim_t D>
+            const std::size_t WideMultiIndex<UINT,D>::BYTES;
+
+            template<class UINT, dim_t D>
+            const std::size_t WideMultiIndex<UINT,D>::WORDS;
+
+            template<class UINT, dim_t D>
+            const std::size_t WideMultiIndex<UINT,D>::LANES_PER_WORD;
+
+            template<class UINT, dim_t D>
+            std::ostream &operator<<(std::ostream &out, const WideMultiIndex<UINT, D> &index)
+            {
+                out << "(";
+                for (dim_t i = 0; i < D-1; i++)
+                    out << index[i] << ", ";
+                if (D != 0)
+                    out << index[D-1];
+                out << ")";
+                return out;
+            }
+        }
+    }
+}
+
+
+namespace std {
+    /**
+     * \cond HIDDEN_SYMBOLS
+     * Provides less functor (compare) for STL containers (notable std::map).
+     * Specializes generic std::less<T>.
+     * \endcond
+     */
+    template<class UINT, waveblocks::dim_t D>
+    struct less< waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> >
+    {
+    private:
+        typedef waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> MultiIndex;
+
+    public:
+        typedef MultiIndex first_argument_type;
+        typedef MultiIndex second_argument_type;
+        typedef bool result_type;
+
+        bool operator()(const MultiIndex &first, const MultiIndex &second) const
+        {
+            return MultiIndex::less_(first, second);
+        }
+    };
+
+    /**
+     * \cond HIDDEN_SYMBOLS
+     * Provides hash functor for STL containers (notable std::unordered_map).
+     * Specializes generic std::hash<T>.
+     * \endcond
+     */
+    template<class UINT, waveblocks::dim_t D>
+    struct hash< waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> >
+    {
+    private:
+        typedef waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> MultiIndex;
+
+    public:
+        std::size_t operator()(const MultiIndex &index) const
+        {
+            std::uint64_t h = 0;
+            for (std::size_t w = 0; w < MultiIndex::WORDS; w++)
+                h = (h ^ index.word_(w)) * UINT64_C(0x9E3779B97F4A7C15);
+            return std::size_t(h ^ (h >> 29));
+        }
+    };
+
+    /**
+     * \cond HIDDEN_SYMBOLS
+     * Provides equality functor for STL containers (notable std::unordered_map).
+     * Specializes generic std::equal_to<T>.
+     * \endcond
+     */
+    template<class UINT, waveblocks::dim_t D>
+    struct equal_to< waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> >
+    {
+    private:
+        typedef waveblocks::wavepackets::shapes::WideMultiIndex<UINT,D> MultiIndex;
+
+    public:
+        typedef MultiIndex first_argument_type;
+        typedef MultiIndex second_argument_type;
+        typedef bool result_type;
+
+        bool operator()(const MultiIndex &first, const MultiIndex &second) const
+        {
+            return MultiIndex::equal_(first, second);
+        }
+    };
+}
@@ -45,12 +45,9 @@ namespace waveblocks {
                 HaWpParamSetDecoder<D> paramset_decoder;
                 wp.parameters() = paramset_decoder(config["parameters"][0]);
 
-                // (3) decode and enumerate shape
+                // (3) decode and enumerate shape (or map it from its cache file)
                 ShapeDecoder<D> shape_decoder;
-                ShapeEnumerator<D,MultiIndex> shape_enumerator;
-                AbstractShape<D>* shape = shape_decoder(config["shapes"][0]);
-                wp.shape() = shape_enumerator.enumerate(shape);
-                delete shape;
+                wp.shape() = shape_decoder.template enumerate<MultiIndex>(config["shapes"][0]);
 
                 return wp;
             }
@@ -6,14 +6,28 @@
 #include <vector>
 #include <array>
 #include <cmath>
+#include <memory>
+#include <sstream>
+#include <cstdio>
+
+#include <unistd.h>
 
 #include <yaml-cpp/yaml.h>
 
 #include "../wavepackets/shapes/shape_commons.hpp"
+#include "../wavepackets/shapes/shape_enumerator.hpp"
+#include "../io/shape_enum_file.hpp"
 
 
 namespace waveblocks {
     namespace yaml {
+        using wavepackets::shapes::AbstractShape;
+        using wavepackets::shapes::HyperCubicShape;
+        using wavepackets::shapes::HyperbolicCutShape;
+        using wavepackets::shapes::LimitedHyperbolicCutShape;
+        using wavepackets::shapes::ShapeEnum;
+        using wavepackets::shapes::ShapeEnumerator;
+
         template<dim_t D>
         struct ShapeDecoder
         {
@@ -42,6 +56,55 @@ namespace waveblocks {
                 throw std::runtime_error("unknown shape type");
             }
 
+            /**
+             * \brief Decodes and enumerates a shape.
+             *
+             * If the shape has a \c cache entry naming a file, the enumeration is memory-mapped from this file
+             * (see io::map_shape_enum()), provided it has been written for a shape with the same
+             * identity key (see AbstractShape::identity()). Shapes without key are never cached.
+             * Otherwise the shape is enumerated and the file is (re)written for later runs.
+             * Failing to write the cache is not an error.
+             *
+             * \code
+             * shapes:
+             * - dimensionality: 3
+             *   limits: [5, 5, 5]
+             *   sparsity: 7.0
+             *   type: hyperbolic
+             *   cache: basis_shape.wbshape
+             * \endcode
+             */
+            template<class MultiIndex>
+            std::shared_ptr< ShapeEnum<D,MultiIndex> > enumerate(YAML::Node const& config)
+            {
+                std::unique_ptr< AbstractShape<D> > shape((*this)(config));
+
+                std::ostringstream out;
+                if (!config["cache"] || !shape->identity(out))
+                    return ShapeEnumerator<D,MultiIndex>().enumerate(*shape);
+
+                std::string cache = config["cache"].as<std::string>();
+                std::string description = out.str();
+
+                auto enumeration = io::map_shape_enum<D,MultiIndex>(cache, &description);
+                if (enumeration)
+                    return enumeration;
+
+                enumeration = ShapeEnumerator<D,MultiIndex>().enumerate(*shape);
+
+                // write to a private file first, since concurrent runs may share the cache
+                std::string temp = cache + ".tmp" + std::to_string(::getpid());
+                try {
+                    io::write_shape_enum(*enumeration, temp, description);
+                    std::rename(temp.c_str(), cache.c_str());
+                }
+                catch (std::runtime_error const&) {
+                    std::remove(temp.c_str());
+                }
+
+                return enumeration;
+            }
+
         private:
             std::array<int,D> decode_limits(YAML::Node const& node)
             {